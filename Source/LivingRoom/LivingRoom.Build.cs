@@ -1,5 +1,6 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
+using System.IO;
 using UnrealBuildTool;
 
 public class LivingRoom : ModuleRules
@@ -8,10 +9,38 @@ public class LivingRoom : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 	
+		// The in-process Stockfish backend includes the engine headers, whose "Stockfish" namespace
+		// clashes with the Stockfish wrapper class if both land in the same unity translation unit
+		bUseUnity = false;
+
 		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore" });
 
 		PrivateDependencyModuleNames.AddRange(new string[] {  });
 
+		// Link the vendored Stockfish engine directly into the module if its static library was built
+		// ("make library" in Source/Stockfish/Stockfish-<Platform>/src). Otherwise the module falls back
+		// to launching the Stockfish executable and talking UCI through pipes.
+		string StockfishPlatform = "Stockfish-Linux";
+		if (Target.Platform == UnrealTargetPlatform.Win64)
+		{
+			StockfishPlatform = "Stockfish-Windows";
+		}
+		else if (Target.Platform == UnrealTargetPlatform.Mac)
+		{
+			StockfishPlatform = "Stockfish-MacOS";
+		}
+
+		string StockfishDirectory = Path.Combine(ModuleDirectory, "..", "Stockfish", StockfishPlatform);
+		string StockfishLibrary = Path.Combine(StockfishDirectory, "src", "libstockfish.a");
+		bool bStockfishInProcess = File.Exists(StockfishLibrary);
+
+		if (bStockfishInProcess)
+		{
+			PrivateIncludePaths.Add(StockfishDirectory);
+			PublicAdditionalLibraries.Add(StockfishLibrary);
+		}
+		PublicDefinitions.Add("WITH_STOCKFISH_INPROCESS=" + (bStockfishInProcess ? "1" : "0"));
+
 		// Uncomment if you are using Slate UI
 		// PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" });
 		
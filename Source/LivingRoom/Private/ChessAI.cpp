@@ -1,10 +1,18 @@
 #include "ChessAI.h"        // Includes the UChessAI class declarations
 #include "ChessAIHandler.h" // Includes the ChessAIHandler class for interacting with the chess AI
 #include "FENParser.h"      // Includes the FENParser class for parsing FEN strings
+#include "ResponseCache.h"  // Includes the ResponseCache class holding previous AI responses
+#include "LatencyProfiler.h" // Includes the LatencyProfiler class measuring the stages of AI requests
+#include "Async/Async.h"    // Includes AsyncTask for warming up the AI on a background thread
 
-// Global instances of the ChessAIHandler and FENParser classes
+// Global instance of the ChessAIHandler class
 ChessAIHandler ChessAIHandlerInstance;
-FENParser FENParserInstance;
+
+// The Blueprint struct is filled with memcpy, so its arrays must match the packed response byte for byte
+static_assert(sizeof(ChessMove) == sizeof(uint16), "FChessAIResponse::LegalMoves holds packed ChessMove values");
+static_assert(sizeof(FChessAIResponse::LegalMoves) == sizeof(StockfishResponse::legalMoves), "FChessAIResponse::LegalMoves must hold every legal move");
+static_assert(sizeof(FChessAIResponse::Pieces) == sizeof(StockfishResponse::board), "FChessAIResponse::Pieces must hold the whole board");
+static_assert(sizeof(FChessAIResponse::MoveTargets) == sizeof(ChessMoveTargets::targets), "FChessAIResponse::MoveTargets holds one bitboard per square");
 
 // Converts an FString to a std::string
 std::string ConvertToStdString(FString ToConvert) {
@@ -22,76 +30,284 @@ bool UChessAI::IndexIsUpperCase(const FString& Input) {
 }
 
 // Retrieves feedback from the chess AI based on the skill level and current FEN
-void UChessAI::GetAIFeedback(const int SkillLevel, const FString CurrentFEN, FString& CorrectedFEN, FString& BestMove, TArray<FString>& LegalMoves, bool& IsCheckmate, bool& IsDrawOfferable) {
+void UChessAI::GetAIFeedback(const int SkillLevel, const FString CurrentFEN, FString& CorrectedFEN, FString& BestMove, TArray<FString>& LegalMoves, bool& IsCheckmate, bool& IsDrawOfferable, const int Board, const bool Background) {
+    GetAIFeedbackForRequest(SkillLevel, CurrentFEN, CorrectedFEN, BestMove, LegalMoves, IsCheckmate, IsDrawOfferable, Board, Background, nullptr);
+}
+
+// Retrieves feedback from the chess AI for a request that can be cancelled on its own
+void UChessAI::GetAIFeedbackForRequest(const int SkillLevel, const FString CurrentFEN, FString& CorrectedFEN, FString& BestMove, TArray<FString>& LegalMoves, bool& IsCheckmate, bool& IsDrawOfferable, const int Board, const bool Background, AIRequestToken* Request) {
     std::string CurrentFENString = ConvertToStdString(CurrentFEN);
 
     // Get the response from the ChessAIHandler
-    StockfishResponse Response = ChessAIHandlerInstance.getChessAIFeedback(SkillLevel, CurrentFENString);
+    const AIRequestPriority Priority = Background ? AIRequestPriority::Background : AIRequestPriority::Interactive;
+    StockfishResponse Response = ChessAIHandlerInstance.getChessAIFeedback(SkillLevel, CurrentFENString, Priority, Board, Request);
 
     // Convert Stockfish response to FString and populate the output parameters
     CorrectedFEN = ConvertToFString(Response.fen);
-    BestMove = ConvertToFString(Response.bestMove);
-    IsCheckmate = Response.isCheckmate;
+    BestMove = Response.bestMove.isValid() ? ConvertToFString(Response.bestMove.toUCI()) : FString();
+    IsCheckmate = Response.isCheckmate();
+    IsDrawOfferable = Response.isDrawOfferable();
 
-    // Convert legal moves to FString and populate the LegalMoves array
-    for (const std::string& Move : Response.legalMoves) {
-        LegalMoves.Add(ConvertToFString(Move));
+    // Write the packed legal moves in the notation that marks castling, en passant and pawn promotion moves
+    LegalMoves.Reset(Response.legalMoveCount);
+    for (int Index = 0; Index < Response.legalMoveCount; ++Index) {
+        LegalMoves.Add(ConvertToFString(Response.legalMoves[Index].toGameNotation()));
     }
+}
+
+// Retrieves feedback from the chess AI as a packed struct
+void UChessAI::GetAIResponse(const int SkillLevel, const FString CurrentFEN, FChessAIResponse& Response, const int Board, const bool Background) {
+    const AIRequestPriority Priority = Background ? AIRequestPriority::Background : AIRequestPriority::Interactive;
+    const StockfishResponse Result = ChessAIHandlerInstance.getChessAIFeedback(SkillLevel, ConvertToStdString(CurrentFEN), Priority, Board);
 
-    // After correcting the FEN with the AI, extract further details like draw offerability
-    // And adjust the Castling, EnPassant and Pawn Promotion strings to easily detect them
-    ExtractFENDetails(CorrectedFEN, LegalMoves, IsDrawOfferable);
+    // Copy the packed fields as they are; only the FEN needs a conversion
+    Response.CorrectedFEN = FString(UTF8_TO_TCHAR(Result.fen.c_str()));
+    Response.BestMove = Result.bestMove.data;
+    FMemory::Memcpy(Response.LegalMoves, Result.legalMoves, Result.legalMoveCount * sizeof(ChessMove));
+    Response.LegalMoveCount = Result.legalMoveCount;
+    FMemory::Memcpy(Response.MoveTargets, Result.moveTargets.targets, sizeof(Response.MoveTargets));
+    FMemory::Memcpy(Response.Pieces, Result.board, sizeof(Response.Pieces));
+    Response.Flags = Result.flags;
+    Response.ResponseTime = Result.responseTime;
 }
 
-// Parses a FEN string and populates board details and game state information
-void UChessAI::ParseFEN(const FString& FEN, TArray<FString>& Board, bool& WhitesTurn, TArray<bool>& CastlingRights, FString& EnPassantTarget, int& HalfMoveClock, int& FullMoveNumber) {
-    std::string FENString = ConvertToStdString(FEN);
-    std::vector<std::string> BoardStringVector;
-    std::vector<bool> CastlingRightsVector;
-    std::string EnPassantString = ConvertToStdString(EnPassantTarget);
-
-    // Convert board and castling rights data
-    for (const FString& Square : Board) {
-        BoardStringVector.push_back(ConvertToStdString(Square));
+// Returns a legal move of a packed response
+int UChessAI::GetAILegalMove(const FChessAIResponse& Response, const int Index) {
+    if (Index < 0 || Index >= Response.LegalMoveCount) {
+        return 0;
     }
+    return Response.LegalMoves[Index];
+}
 
-    for (bool CastlingRight : CastlingRights) {
-        CastlingRightsVector.push_back(CastlingRight);
+// Decodes a packed move into board indices, its type and the promotion piece
+void UChessAI::DecodeAIMove(const int Move, int& FromIndex, int& ToIndex, int& MoveType, FString& PromotionPiece) {
+    const ChessMove Decoded(static_cast<uint16>(Move));
+    FromIndex = ChessPosition::toBitboardSquare(Decoded.fromSquare());
+    ToIndex = ChessPosition::toBitboardSquare(Decoded.kingDestinationSquare());
+    MoveType = static_cast<int>(Decoded.type()) >> 14;
+
+    PromotionPiece.Reset();
+    if (Decoded.isPromotion()) {
+        const bool White = Decoded.toSquare() / 8 == 7;  // White promotes on the 8th rank
+        const TCHAR Piece = static_cast<TCHAR>(Decoded.promotionPiece());
+        PromotionPiece = FString::Chr(White ? FChar::ToUpper(Piece) : Piece);
     }
+}
+
+// Converts a packed move into the notation of GetAIFeedback
+FString UChessAI::AIMoveToString(const int Move) {
+    return ConvertToFString(ChessMove(static_cast<uint16>(Move)).toGameNotation());
+}
+
+// Returns the precomputed destinations of a square
+int64 UChessAI::GetAIMoveTargets(const FChessAIResponse& Response, const int FromIndex, TArray<int>& ToIndices) {
+    ToIndices.Reset();
+    if (FromIndex < 0 || FromIndex >= 64) {
+        return 0;
+    }
+
+    const uint64 Targets = static_cast<uint64>(Response.MoveTargets[ChessPosition::toBitboardSquare(FromIndex)]);
+    for (uint64 Remaining = Targets; Remaining != 0; Remaining &= Remaining - 1) {
+        ToIndices.Add(ChessPosition::toBitboardSquare(static_cast<int>(FMath::CountTrailingZeros64(Remaining))));
+    }
+    return static_cast<int64>(Targets);
+}
+
+// Checks a move against the precomputed destinations
+bool UChessAI::IsAIMoveLegal(const FChessAIResponse& Response, const int FromIndex, const int ToIndex) {
+    if (FromIndex < 0 || FromIndex >= 64 || ToIndex < 0 || ToIndex >= 64) {
+        return false;
+    }
+    const uint64 Targets = static_cast<uint64>(Response.MoveTargets[ChessPosition::toBitboardSquare(FromIndex)]);
+    return (Targets >> ChessPosition::toBitboardSquare(ToIndex)) & 1;
+}
+
+// Reads the status flags of a packed response
+void UChessAI::GetAIResponseStatus(const FChessAIResponse& Response, bool& IsCheckmate, bool& IsDrawOfferable, bool& WhitesTurn) {
+    IsCheckmate = (Response.Flags & ResponseCheckmate) != 0;
+    IsDrawOfferable = (Response.Flags & ResponseDrawOfferable) != 0;
+    WhitesTurn = (Response.Flags & ResponseWhitesTurn) != 0;
+}
+
+// Starts the AI on a background thread, so the first AI move does not pay for the engine start
+void UChessAI::Prewarm(const int SkillLevel) {
+    AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [SkillLevel]() {
+        ChessAIHandlerInstance.prewarmChessAI(SkillLevel);
+    });
+}
+
+// Asks the running AI searches of a board to finish early
+void UChessAI::CancelAIFeedback(const int Board) {
+    ChessAIHandlerInstance.stopChessAI(Board);
+}
+
+// Cancels a single request without touching the other searches of its board
+void UChessAI::CancelAIRequest(AIRequestToken* Request) {
+    ChessAIHandlerInstance.cancelRequest(Request);
+}
+
+// Sets how many AI engines search in parallel
+void UChessAI::SetAIEngineCount(const int Count) {
+    ChessAIHandlerInstance.setEngineCount(Count);
+}
+
+// Starts a new game for the AI on one board, or on all of them
+void UChessAI::StartNewAIGame(const int Board) {
+    ChessAIHandlerInstance.startNewGame(Board);
+}
+
+// Sets the wall-clock budget of an AI search
+void UChessAI::SetAITimeBudget(const int Milliseconds) {
+    ChessAIHandlerInstance.setSearchTimeBudget(Milliseconds);
+}
+
+// Returns the duration of the last AI feedback request
+int UChessAI::GetLastAIResponseTime() {
+    return ChessAIHandlerInstance.getLastResponseTime();
+}
+
+// Enables or disables pondering on the player's time
+void UChessAI::SetAIPondering(const bool Enabled) {
+    ChessAIHandlerInstance.setPondering(Enabled);
+}
+
+// Switches the AI processes between pipes and shared memory
+void UChessAI::SetAISharedMemoryTransport(const bool Enabled) {
+    ChessAIHandlerInstance.setSharedMemoryTransport(Enabled);
+    ChessAIHandlerInstance.closeStockfishProcesses();  // Running processes restart with the new transport on their next request
+}
+
+// Returns the hit and miss counters and the size of the response cache
+void UChessAI::GetAICacheStatistics(int64& Hits, int64& Misses, int& CachedResponses) {
+    ResponseCache& Cache = ResponseCache::getInstance();
+    Hits = static_cast<int64>(Cache.getHits());
+    Misses = static_cast<int64>(Cache.getMisses());
+    CachedResponses = static_cast<int>(Cache.getSize());
+}
+
+// Sets the maximum number of cached responses
+void UChessAI::SetAICacheCapacity(const int MaximumResponses) {
+    ResponseCache::getInstance().setCapacity(MaximumResponses > 0 ? MaximumResponses : 1);
+}
+
+// Removes all cached responses
+void UChessAI::ClearAICache() {
+    ResponseCache::getInstance().clear();
+}
+
+// Writes the cached responses to a file
+bool UChessAI::SaveAICache(const FString& FilePath) {
+    return ResponseCache::getInstance().saveToFile(ConvertToStdString(FilePath));
+}
+
+// Loads cached responses from a file
+bool UChessAI::LoadAICache(const FString& FilePath) {
+    return ResponseCache::getInstance().loadFromFile(ConvertToStdString(FilePath));
+}
+
+// Returns the percentiles of a request stage in milliseconds
+bool UChessAI::GetAILatency(const FString& Stage, float& P50, float& P95, float& P99, int& Samples) {
+    AILatencyStage LatencyStage;
+    if (!LatencyProfiler::findStage(ConvertToStdString(Stage), LatencyStage)) {
+        return false;
+    }
+    LatencyProfiler& Profiler = LatencyProfiler::getInstance();
+    P50 = Profiler.getPercentile(LatencyStage, 50.0) / 1000.0f;
+    P95 = Profiler.getPercentile(LatencyStage, 95.0) / 1000.0f;
+    P99 = Profiler.getPercentile(LatencyStage, 99.0) / 1000.0f;
+    Samples = static_cast<int>(Profiler.getSampleCount(LatencyStage));
+    return true;
+}
+
+// Starts writing the request stage durations to a CSV file
+bool UChessAI::StartAILatencyTrace(const FString& FilePath) {
+    return LatencyProfiler::getInstance().startTrace(ConvertToStdString(FilePath));
+}
+
+// Closes the CSV file of the request stage durations
+void UChessAI::StopAILatencyTrace() {
+    LatencyProfiler::getInstance().stopTrace();
+}
+
+// Writes the percentiles of every request stage to a JSON file
+bool UChessAI::SaveAILatencySummary(const FString& FilePath) {
+    return LatencyProfiler::getInstance().writeSummary(ConvertToStdString(FilePath));
+}
+
+// Parses a FEN string and populates board details and game state information
+void UChessAI::ParseFEN(const FString& FEN, TArray<FString>& Board, bool& WhitesTurn, TArray<bool>& CastlingRights, FString& EnPassantTarget, int& HalfMoveClock, int& FullMoveNumber) {
+    FTCHARToUTF8 FENString(*FEN);  // Converts on the stack for FEN-sized strings
+    ChessPosition Position;
 
     // Parse the FEN string
-    FENParserInstance.parseFEN(FENString, BoardStringVector, WhitesTurn, CastlingRightsVector, EnPassantString, HalfMoveClock, FullMoveNumber);
+    FENParser::parseFEN(std::string_view(FENString.Get(), FENString.Length()), Position);
 
     // Convert and populate board and castling rights data
-    Board.Empty();
-    for (const std::string& Square : BoardStringVector) {
-        Board.Add(ConvertToFString(Square));
+    Board.Reset(64);
+    for (char Piece : Position.pieces) {
+        Board.Add(FString::Chr(Piece));
     }
 
-    CastlingRights.Empty();
-    for (bool CastlingRight : CastlingRightsVector) {
-        CastlingRights.Add(CastlingRight);
-    }
+    CastlingRights.Reset(4);
+    CastlingRights.Add((Position.castlingRights & WhiteKingside) != 0);
+    CastlingRights.Add((Position.castlingRights & WhiteQueenside) != 0);
+    CastlingRights.Add((Position.castlingRights & BlackKingside) != 0);
+    CastlingRights.Add((Position.castlingRights & BlackQueenside) != 0);
 
-    EnPassantTarget = ConvertToFString(EnPassantString);
+    WhitesTurn = Position.whitesTurn;
+    EnPassantTarget = (Position.enPassantSquare < 0) ? FString(TEXT("-")) : ConvertToFString(ChessMove::squareName(Position.enPassantSquare));
+    HalfMoveClock = Position.halfMoveClock;
+    FullMoveNumber = Position.fullMoveNumber;
 }
 
-// Extracts legal moves and draw offerable status from a FEN string
-void UChessAI::ExtractFENDetails(const FString& FEN, TArray<FString>& LegalMoves, bool& DrawOfferable) {
-    std::string FENString = ConvertToStdString(FEN);
-    std::vector<std::string> LegalMovesString;
+// Parses a FEN string into the packed board state without any heap allocation
+bool UChessAI::ParseFENState(const FString& FEN, FChessBoardState& BoardState) {
+    FTCHARToUTF8 FENString(*FEN);  // Converts on the stack for FEN-sized strings
+    ChessPosition Position;
+    const bool Valid = FENParser::parseFEN(std::string_view(FENString.Get(), FENString.Length()), Position);
+
+    // Copy the compact position into the Blueprint struct
+    FMemory::Memcpy(BoardState.Pieces, Position.pieces, sizeof(BoardState.Pieces));
+    FMemory::Memcpy(BoardState.PieceBitboards, Position.pieceBitboards, sizeof(BoardState.PieceBitboards));
+    BoardState.WhitePieces = static_cast<int64>(Position.colorBitboards[0]);
+    BoardState.BlackPieces = static_cast<int64>(Position.colorBitboards[1]);
+    BoardState.WhitesTurn = Position.whitesTurn;
+    BoardState.CastlingRights = Position.castlingRights;
+    BoardState.EnPassantSquare = Position.enPassantSquare;
+    BoardState.HalfMoveClock = Position.halfMoveClock;
+    BoardState.FullMoveNumber = Position.fullMoveNumber;
+    return Valid;
+}
 
-    // Convert legal moves data
-    for (const FString& Move : LegalMoves) {
-        LegalMovesString.push_back(ConvertToStdString(Move));
+// Returns the FEN character of the piece on a square of a parsed board state
+FString UChessAI::GetPieceAt(const FChessBoardState& BoardState, const int Index) {
+    if (Index < 0 || Index >= 64) {
+        return FString(TEXT("."));
     }
+    return FString::Chr(static_cast<TCHAR>(BoardState.Pieces[Index]));
+}
 
-    // Extract details from the FEN string
-    FENParserInstance.extractFENDetails(FENString, LegalMovesString, DrawOfferable);
+// Checks if a square of a parsed board state is empty
+bool UChessAI::IsSquareEmpty(const FChessBoardState& BoardState, const int Index) {
+    return Index < 0 || Index >= 64 || BoardState.Pieces[Index] == '.';
+}
 
-    // Convert and populate legal moves data
-    LegalMoves.Empty();
-    for (const std::string& Move : LegalMovesString) {
-        LegalMoves.Add(ConvertToFString(Move));
+// Extracts legal moves and draw offerable status from a FEN string
+void UChessAI::ExtractFENDetails(const FString& FEN, TArray<FString>& LegalMoves, bool& DrawOfferable) {
+    FTCHARToUTF8 FENString(*FEN);  // Converts on the stack for FEN-sized strings
+    ChessPosition Position;
+    FENParser::parseFEN(std::string_view(FENString.Get(), FENString.Length()), Position);
+    DrawOfferable = (Position.halfMoveClock >= 100); // Check if a draw can be offered based on half-move clock
+
+    // Decode every move against the position and write it back in the annotated notation
+    for (FString& Move : LegalMoves) {
+        std::string MoveString = ConvertToStdString(Move);
+        if (MoveString.size() >= 7 && MoveString.compare(4, 2, "->") == 0) {
+            MoveString.erase(4, 2);  // "e7e8->Q" is already annotated; decode it as "e7e8Q"
+        }
+        const ChessMove Decoded = ChessMove::fromUCI(MoveString, Position);
+        if (Decoded.isValid()) {
+            Move = ConvertToFString(Decoded.toGameNotation());
+        }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ChessAIAsyncAction.h"
+#include "ChessAI.h"                // UChessAI, whose GetAIFeedback does the actual work on the worker thread
+#include "Async/Async.h"            // AsyncTask for moving work between the game thread and background threads
+
+// Creates the async action; the request itself starts when Blueprint activates the node
+UChessAIAsyncAction* UChessAIAsyncAction::GetAIFeedbackAsync(UObject* WorldContextObject, const int SkillLevel, const FString CurrentFEN, const int Board, const bool Background) {
+    UChessAIAsyncAction* Action = NewObject<UChessAIAsyncAction>();
+    Action->SkillLevel = SkillLevel;
+    Action->CurrentFEN = CurrentFEN;
+    Action->Board = Board;
+    Action->bBackground = Background;
+    Action->RegisterWithGameInstance(WorldContextObject);  // Keeps the action alive until SetReadyToDestroy
+    return Action;
+}
+
+// Runs the engine request on a background thread so rendering never waits for the search
+void UChessAIAsyncAction::Activate() {
+    TWeakObjectPtr<UChessAIAsyncAction> WeakThis(this);
+    const int RequestSkillLevel = SkillLevel;
+    const FString RequestFEN = CurrentFEN;
+    const int RequestBoard = Board;
+    const bool RequestBackground = bBackground;
+    std::shared_ptr<AIRequestToken> RequestToken = Request;
+
+    AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [WeakThis, RequestSkillLevel, RequestFEN, RequestBoard, RequestBackground, RequestToken]() {
+        FString CorrectedFEN;
+        FString BestMove;
+        TArray<FString> LegalMoves;
+        bool IsCheckmate = false;
+        bool IsDrawOfferable = false;
+
+        // Skip the search entirely if the request was cancelled while it was queued
+        if (!RequestToken->cancelled) {
+            UChessAI::GetAIFeedbackForRequest(RequestSkillLevel, RequestFEN, CorrectedFEN, BestMove, LegalMoves, IsCheckmate, IsDrawOfferable, RequestBoard, RequestBackground, RequestToken.get());
+        }
+
+        // Delegates must be broadcast on the game thread
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, CorrectedFEN, BestMove, LegalMoves, IsCheckmate, IsDrawOfferable]() {
+            if (UChessAIAsyncAction* Action = WeakThis.Get()) {
+                Action->Finish(CorrectedFEN, BestMove, LegalMoves, IsCheckmate, IsDrawOfferable);
+            }
+        });
+    });
+}
+
+// Marks the request as cancelled and stops its search, so the worker thread returns quickly; searches of other
+// requests on the same board keep running
+void UChessAIAsyncAction::Cancel() {
+    UChessAI::CancelAIRequest(Request.get());
+}
+
+// Reports the results to Blueprint and lets the action be garbage collected
+void UChessAIAsyncAction::Finish(const FString& CorrectedFEN, const FString& BestMove, const TArray<FString>& LegalMoves, bool IsCheckmate, bool IsDrawOfferable) {
+    if (Request->cancelled) {
+        OnCancelled.Broadcast(CurrentFEN, FString(), TArray<FString>(), false, false);
+    }
+    else {
+        OnCompleted.Broadcast(CorrectedFEN, BestMove, LegalMoves, IsCheckmate, IsDrawOfferable);
+    }
+    SetReadyToDestroy();
+}
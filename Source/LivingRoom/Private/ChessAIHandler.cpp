@@ -1,6 +1,12 @@
 #include "ChessAIHandler.h"  // Includes the ChessAIHandler class, which manages interactions with the chess AI and processes Stockfish responses.
 #include "FENParser.h"       // Includes the FENParser class, used to parse and extract information from FEN (Forsyth-Edwards Notation) strings.
+#include "LatencyProfiler.h" // Includes the SCOPE_AI_LATENCY timers for the stages of a request.
+#include "ResponseCache.h"   // Includes the ResponseCache class, which answers repeated positions without asking the engine.
 #include "Stockfish.h"       // Includes the Stockfish class, which handles communication with the Stockfish chess engine.
+#include <algorithm>         // Provides std::copy for the board array.
+#include <chrono>            // Provides steady_clock for measuring the response time.
+#include <iterator>          // Provides std::begin and std::end for the board array.
+#include <string_view>       // Provides std::string_view for parsing the response lines without copying them.
 #include <string>            // Provides std::string for managing text strings, like moves and FEN strings.
 #include <vector>            // Provides std::vector for dynamic arrays, such as lists of moves and board states.
 
@@ -10,110 +16,184 @@ const std::string YELLOW = "\033[33m";  // Color code for yellow text.
 const std::string BLUE = "\033[34m";    // Color code for blue text.
 const std::string WHITE = "\033[0m";    // Reset color code to default.
 
-bool whitesTurn = false; // Bool to determine if white is the current playing color
+// Warms the engines up before the first request
+void ChessAIHandler::prewarmChessAI(const int& skillLevel) {
+    EnginePool::getInstance().prewarm(skillLevel);
+}
 
-// Creates an instance of the Stockfish class to interact with the chess engine.
-Stockfish& stockfish = Stockfish::getInstance();
+// Asks the running AI searches of a board to finish early
+void ChessAIHandler::stopChessAI(int board) {
+    EnginePool::getInstance().stop(board);
+}
 
-// Close all open stockfish connections and handles
-void ChessAIHandler::closeStockfish() {
-    stockfish.closeStockfish();
+// Cancels a single request without stopping the searches of other requests
+void ChessAIHandler::cancelRequest(AIRequestToken* token) {
+    token->cancelled = true;
+    EnginePool::getInstance().cancel(token);
 }
 
-// Gets feedback from the chess AI based on the provided skill level and FEN string.
-// Returns the response containing best move, legal moves, board state, and other details.
-StockfishResponse ChessAIHandler::getChessAIFeedback(const int& skillLevel, const std::string& fen) {
-    std::vector<std::string> response = stockfish.requestStockfish(skillLevel, fen); // Requests feedback from Stockfish.
-    return extractResponse(response); // Extracts and returns the relevant information from the response.
+// Sets the number of engines searching in parallel
+void ChessAIHandler::setEngineCount(const int& count) {
+    EnginePool::getInstance().setEngineCount(count);
 }
 
-// Extracts relevant details from the Stockfish response and updates the StockfishResponse object.
-// Parses the response lines to find the best move, legal moves, board state, and FEN.
-StockfishResponse ChessAIHandler::extractResponse(const std::vector<std::string>& response) {
-    FENParser fenParser;  // Creates an instance of FENParser to handle FEN strings.
-    StockfishResponse result;  // Holds the extracted information from the response.
-    bool drawOfferable = false;  // Flag to indicate if a draw offer is possible.
+// Starts a new game on one board, or on all of them
+void ChessAIHandler::startNewGame(const int& board) {
+    EnginePool::getInstance().startNewGame(board);
+}
 
-    // Process each line of the response to extract information
-    for (const std::string& line : response) {
-        checkForBestMove(line, result.bestMove);  // Checks if the line contains the best move.
-        checkForLegalMoves(line, result.legalMoves);  // Checks if the line contains legal moves.
-        checkForBoardPart(line, result.board);  // Checks if the line represents a part of the board.
-        checkForFen(line, result.fen);  // Checks if the line contains the FEN string.
-    }
+// Sets the wall-clock budget of an engine search
+void ChessAIHandler::setSearchTimeBudget(const int& milliseconds) {
+    EnginePool::getInstance().setSearchTimeBudget(milliseconds);
+}
 
-    result.isCheckmate = result.legalMoves.empty();  // Determine if it's checkmate based on the absence of legal moves.
-    fenParser.extractFENDetails(result.fen, result.legalMoves, drawOfferable);  // Extract additional FEN details.
+// Returns the wall-clock time of the last request
+int ChessAIHandler::getLastResponseTime() const {
+    return lastResponseTime;
+}
 
-    //Remove \r (Carriage Return) if it is contained - seems like Stockfish was programmed on a Mac
-    if (!result.fen.empty() && result.fen[result.fen.size() - 1] == '\r') {
-        result.fen.erase(result.fen.size() - 1);
-    }
+// Enables or disables pondering on the player's time
+void ChessAIHandler::setPondering(const bool& enabled) {
+    EnginePool::getInstance().setPondering(enabled);
+}
 
-    return result;  // Return the populated StockfishResponse object.
+// Switches the Stockfish processes between pipes and shared memory
+void ChessAIHandler::setSharedMemoryTransport(const bool& enabled) {
+    EnginePool::getInstance().setSharedMemoryTransport(enabled);
 }
 
-// Checks if a line contains the FEN string and updates the fen variable.
-// Assumes the line starts with "Fen: " and extracts the FEN part.
-void ChessAIHandler::checkForFen(const std::string& line, std::string& fen) {
-    if (line.find("Fen: ") != std::string::npos) {
-        fen = line.substr(5);  // Extracts the FEN string from the line.
-        // Checks if white is the current color. Since the fen string is always located behind the moves
-        // in the response, we have to switch the color logic here!
-        whitesTurn = fen.find("w") != std::string::npos ? false : true;
-    }
+// Close all open stockfish connections and handles
+void ChessAIHandler::closeStockfish() {
+    EnginePool::getInstance().closeAll();
 }
 
-// Checks if a line from the response contains the best move and updates the bestMove variable.
-// Assumes the format "bestmove <move>" and extracts the move part.
-void ChessAIHandler::checkForBestMove(const std::string& line, std::string& bestMove) {
-    if (line.find("bestmove") != std::string::npos) {
-        if (line[13] == ' ') {
-            bestMove = line.substr(9, 4);  // Extracts the normal move from the string.
-        }
-        else {
-            bestMove = line.substr(9, 5);  // Extracts the promotion move from the string.
+// Close the Stockfish processes, so they restart with the current settings
+void ChessAIHandler::closeStockfishProcesses() {
+    EnginePool::getInstance().closeProcessEngines();
+}
+
+// Gets feedback from the chess AI based on the provided skill level and FEN string.
+// Returns the response containing best move, legal moves, board state, and other details.
+StockfishResponse ChessAIHandler::getChessAIFeedback(const int& skillLevel, const std::string& fen, AIRequestPriority priority, int board, AIRequestToken* token) {
+    SCOPE_AI_LATENCY(Total);
+    const auto startTime = std::chrono::steady_clock::now();
+    StockfishResponse result;
+    ResponseCache& responseCache = ResponseCache::getInstance();  // Shared by all handlers and boards
+
+    // Answers repeated positions (replays, undo/redo, openings) from the cache without an engine round trip.
+    // Responses are cached per time budget, since the budget limits the search as much as the skill level does.
+    ChessPosition position;
+    bool validFEN = false;
+    bool cached = false;
+    std::uint64_t positionHash = 0;
+    const SearchLimits limits = EnginePool::getInstance().limitsFor(skillLevel);
+    {
+        SCOPE_AI_LATENCY(CacheLookup);
+        validFEN = FENParser::parseFEN(std::string_view(fen), position);
+        positionHash = ResponseCache::hashPosition(position);
+        cached = validFEN && responseCache.find(positionHash, skillLevel, limits, result);
+    }
+    if (cached) {
+        EnginePool::getInstance().updateGameSession(board, fen);  // The board's move list still has to contain this position
+        result.responseTime = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count());
+        lastResponseTime = result.responseTime;
+        return result;
+    }
+
+    AIRequestToken requestToken;  // Lets the engine report a stopped search for requests that came without a token
+    if (!token) {
+        token = &requestToken;
+    }
+    std::vector<std::string> response;
+    {
+        // Waits for a free engine (interactive requests first) and returns it to the pool right after the search
+        EnginePool::Lease lease = EnginePool::getInstance().acquire(priority, board, token);
+        if (!lease) {
+            return result;  // Cancelled while waiting for an engine
         }
+        response = lease.engine().requestStockfish(skillLevel, fen, lease.session(), token); // Requests feedback from Stockfish.
     }
-}
 
-// Inline function to check if a line contains a pawn promotion move.
-// Returns true if the line specifies a pawn promotion (e.g., "e7e8q").
-static bool checkForPromotionPiece(const std::string& line) {
-    if (line.length() >= 5) {
-        std::vector<char> promotionPieces = { 'q', 'r', 'b', 'n' };  // List of valid promotion pieces.
-        for (char promotionPiece : promotionPieces) {
-            if (promotionPiece == line[4]) {
-                return true;  // Promotion piece found.
+    // Takes the legal moves straight from the move generator when the engine is linked in-process.
+    {
+        SCOPE_AI_LATENCY(LegalMoves);
+        std::vector<uint16_t> packedMoves;
+        if (Stockfish::requestLegalMoves(fen, packedMoves)) {
+            for (uint16_t packedMove : packedMoves) {
+                result.addLegalMove(ChessMove(packedMove));
             }
         }
     }
-    return false;  // No promotion piece found.
+
+    extractResponse(response, result); // Extracts the relevant information from the response.
+
+    // Only complete answers are cached: not after a timeout, and not if the search was stopped or cancelled early.
+    // The engine marks the token whenever it stops this request's search, whichever thread asked for the stop.
+    // A budget changed during the search leaves it unclear which limits the engine applied; its answer is not cached.
+    const SearchLimits limitsAfter = EnginePool::getInstance().limitsFor(skillLevel);
+    const bool sameLimits = (limitsAfter.moveTime == limits.moveTime) && (limitsAfter.nodes == limits.nodes);
+    if (validFEN && !result.fen.empty() && result.bestMove.isValid() && !token->stopped && !token->cancelled && sameLimits) {
+        responseCache.insert(positionHash, skillLevel, limits, result);
+    }
+
+    // Reports the time actually spent, so the game can check its latency budget
+    result.responseTime = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count());
+    lastResponseTime = result.responseTime;
+    return result;
 }
 
-// Checks if a line contains legal moves and updates the legalMoves vector.
-// Also checks for pawn promotion and formats the move accordingly.
-void ChessAIHandler::checkForLegalMoves(const std::string& line, std::vector<std::string>& legalMoves) {
-    if (line.find(": 1") != std::string::npos && line.find("Node") == std::string::npos) {
-        std::string move = line.substr(0, 4);  // Extracts the move from the line.
+// Extracts relevant details from the Stockfish response and updates the StockfishResponse object.
+// Only the FEN is copied as text; the board, the flags and the moves are stored in their packed form.
+void ChessAIHandler::extractResponse(const std::vector<std::string>& response, StockfishResponse& result) {
+    SCOPE_AI_LATENCY(OutputParsing);
+    std::string_view bestMove;
+    const bool movesGenerated = result.legalMoveCount > 0;  // Legal moves already came from the move generator
 
-        if (checkForPromotionPiece(line)) {
-            char promotionPiece = line[4];  // Gets the promotion piece.
-            promotionPiece = whitesTurn ? _toupper(promotionPiece) : promotionPiece; // Set the promotionPiece based on current color
-            legalMoves.push_back(move + "->" + promotionPiece);  // Adds promotion move to legal moves.
+    // The "Fen: " line is printed before the perft lines, but the moves are decoded after the position is known
+    for (const std::string& line : response) {
+        std::string_view text(line);
+        if (!text.empty() && text.back() == '\r') {
+            text.remove_suffix(1);  // Remove \r (Carriage Return) if it is contained - seems like Stockfish was programmed on a Mac
         }
-        else if (move != "Key:" && move != "Fen:") {
-            legalMoves.push_back(move);  // Adds the move to legal moves.
+        if (text.substr(0, 5) == "Fen: ") {
+            result.fen.assign(text.substr(5));
+        }
+        else if (text.substr(0, 9) == "bestmove ") {
+            bestMove = text.substr(9, text.find(' ', 9) - 9);  // Without " ponder <move>"
         }
     }
-}
 
-// Checks if a line contains part of the board representation and updates the board vector.
-// Adds lines that represent the board state.
-void ChessAIHandler::checkForBoardPart(const std::string& line, std::vector<std::string>& board) {
-    if ((line.find(" +---+") != std::string::npos) || (line.find(" | ") != std::string::npos) ||
-        (line.find("   a") != std::string::npos)) {
-        board.push_back(line);  // Adds the line to the board representation.
+    SCOPE_AI_LATENCY(FENProcessing);
+    ChessPosition position;
+    const bool validFEN = FENParser::parseFEN(std::string_view(result.fen), position);
+    if (validFEN) {
+        std::copy(std::begin(position.pieces), std::end(position.pieces), std::begin(result.board));
+    }
+
+    // "go perft 1" prints one line per legal move, e.g. "e2e4: 1" or "e7e8q: 1"
+    if (!movesGenerated) {
+        for (const std::string& line : response) {
+            const std::string_view text(line);
+            const size_t separator = text.find(": 1");
+            if (separator == 4 || separator == 5) {  // Skips "Nodes searched: 20" and the lines of the board
+                const ChessMove move = ChessMove::fromUCI(text.substr(0, separator), position);
+                if (move.isValid()) {
+                    result.addLegalMove(move);
+                }
+            }
+        }
+    }
+    result.bestMove = ChessMove::fromUCI(bestMove, position);
+
+    result.flags = 0;
+    if (result.legalMoveCount == 0) {
+        result.flags |= ResponseCheckmate;  // Determine if it's checkmate based on the absence of legal moves.
+    }
+    if (validFEN && position.halfMoveClock >= 100) {
+        result.flags |= ResponseDrawOfferable;  // A draw can be offered after fifty moves without capture or pawn move.
+    }
+    if (validFEN && position.whitesTurn) {
+        result.flags |= ResponseWhitesTurn;
     }
 }
 
@@ -122,19 +202,19 @@ void ChessAIHandler::checkForBoardPart(const std::string& line, std::vector<std:
 void ChessAIHandler::printStockfishResponse(const StockfishResponse& response, const std::string& toPrint) {
     if ((toPrint.find("Board") != std::string::npos) || toPrint == "All") {
         std::cout << "Board Representation:\n";
-        for (const std::string& line : response.board) {
-            std::cout << line << "\n";  // Prints each line of the board representation.
+        for (int row = 0; row < 8; ++row) {
+            std::cout << std::string(response.board + row * 8, 8) << "\n";  // Prints each rank, starting with the 8th.
         }
     }
 
     if ((toPrint.find("BestMove") != std::string::npos) || toPrint == "All") {
-        std::cout << "Best Move: " << YELLOW << response.bestMove << WHITE << "\n";  // Prints the best move in yellow.
+        std::cout << "Best Move: " << YELLOW << (response.bestMove.isValid() ? response.bestMove.toUCI() : "(none)") << WHITE << "\n";  // Prints the best move in yellow.
     }
 
     if ((toPrint.find("LegalMoves") != std::string::npos) || toPrint == "All") {
         std::string legalMoves;
-        for (const std::string& move : response.legalMoves) {
-            legalMoves.append(move + " ");  // Concatenates legal moves into a single string.
+        for (int move = 0; move < response.legalMoveCount; ++move) {
+            legalMoves.append(response.legalMoves[move].toGameNotation() + " ");  // Concatenates legal moves into a single string.
         }
         std::cout << "Legal Moves: " << GREEN << legalMoves << WHITE << "\n";  // Prints legal moves in green.
     }
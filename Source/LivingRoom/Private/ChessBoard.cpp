@@ -2,26 +2,31 @@
 
 
 #include "ChessBoard.h"
+#include "ChessAI.h"          // Warms up the chess AI while the level loads
+#include "ChessBoardDiff.h"   // Computes the changes between two piece placements
+#include "FENParser.h"        // Parses FEN strings into the compact piece placement
+
+// Offset to ensure the pieces are placed slightly above the tiles
+static const FVector PieceOffset = { 0.0f, 0.0f, 200.0f };
 
 // Sets default values
 AChessBoard::AChessBoard()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+ 	// The board only changes through UpdateBoardFromFEN, so it never needs to tick
+	PrimaryActorTick.bCanEverTick = false;
+
+	// Start with an empty board, so the first UpdateBoardFromFEN places every piece
+	FMemory::Memset(CurrentPlacement, '.', sizeof(CurrentPlacement));
+	PiecesOnBoard.Init(nullptr, 64);
 }
 
 // Called when the game starts or when spawned
 void AChessBoard::BeginPlay()
 {
 	Super::BeginPlay();
-	
-}
-
-// Called every frame
-void AChessBoard::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
 
+	// Start the engine in the background, so the first AI move is as fast as every later one
+	UChessAI::Prewarm();
 }
 
 // Function to calculate the location of a tile on the chessboard based on its file (letter) and rank (number)
@@ -40,6 +45,7 @@ FVector AChessBoard::CalculateFieldLocation(int LetterIndex, int NumberIndex) {
 // Function to construct all fields (tiles) on the chessboard, placing them in LightTiles and DarkTiles meshes
 void AChessBoard::ConstructCheckboardPattern(UHierarchicalInstancedStaticMeshComponent* LightTiles, UHierarchicalInstancedStaticMeshComponent* DarkTiles) {
 	FieldLocations.Reset();  // Clear any previous tile locations
+	FieldLocationsByIndex.SetNum(64);
 
 	// Loop through the chessboard files (A to H)
 	for (int FieldLetterIndex = 0; FieldLetterIndex < 8; FieldLetterIndex++) {
@@ -53,8 +59,9 @@ void AChessBoard::ConstructCheckboardPattern(UHierarchicalInstancedStaticMeshCom
 			// Calculate the 3D location for the current tile
 			FVector FieldLocation = CalculateFieldLocation(FieldLetterIndex, Number);
 
-			// Add this field's name and location to the map of field locations
+			// Add this field's name and location to the map of field locations, and store it by board index (0 = a8)
 			FieldLocations.Add(FieldName, FieldLocation);
+			FieldLocationsByIndex[((8 - Number) * 8) + FieldLetterIndex] = FieldLocation;
 
 			// Determine the location for the tile, adjusting it slightly along the Z axis
 			FVector TileLocation = { FieldLocation.X, FieldLocation.Y, FieldLocation.Z };
@@ -86,7 +93,6 @@ FString AChessBoard::ConvertIndexToFieldName(int Index) {
 AChessPiece* AChessBoard::SpawnChessPieceBasedOnFENChar(const FString FENChar, FVector FieldLocation) {
     UMaterialInstance* Color; // Material color for the chess piece (white or black).
     FRotator LookDirection = { 0.0f, 0.0f, 0.0f }; // Default rotation for white pieces.
-    FVector Offset = { 0.0f, 0.0f, 200.0f }; // Offset to ensure the piece spawns slightly above the tile.
 
     // Attempt to find the chess piece class corresponding to the FEN character (e.g., 'P' -> Pawn).
     TSubclassOf<AChessPiece>* ChessPieceClassPointer = ChessPieceClasses.Find(FENChar);
@@ -108,7 +114,7 @@ AChessPiece* AChessBoard::SpawnChessPieceBasedOnFENChar(const FString FENChar, F
         }
 
         // Calculate the spawn location relative to the chess tile's position.
-        FVector SpawnLocation = FieldLocation + Offset;
+        FVector SpawnLocation = FieldLocation + PieceOffset;
         //UE_LOG(LogTemp, Warning, TEXT("Spawn location for FENChar: %s is: %s"), *FENChar, *SpawnLocation.ToString());
 
         // Create the transform for spawning the chess piece, including rotation, position, and scale.
@@ -138,23 +144,178 @@ AChessPiece* AChessBoard::SpawnChessPieceBasedOnFENChar(const FString FENChar, F
 
 // Spawns chess pieces on the board according to the provided FEN or similar board representation
 AChessPiece* AChessBoard::SpawnChessPieceOnBoard(const FString FENChar, const int Index) {
-    // Convert the board position index into a chessboard field name (like "A1", "B2", etc.).
-    FString FieldName = ConvertIndexToFieldName(Index);
-    //UE_LOG(LogTemp, Warning, TEXT("Converted index %d to field name: %s"), Index, *FieldName);
-
-    // Check if the field exists in the FieldLocations map.
-    FVector* FieldLocationPointer = FieldLocations.Find(FieldName);
-    if (FieldLocationPointer) {  // Ensure we have a valid location.
-        FVector FieldLocation = *FieldLocationPointer;
-        //UE_LOG(LogTemp, Warning, TEXT("Found location: %s for field name: %s"), *FieldLocation.ToString(), *FieldName);
-
+    // Check if the board index has a field location.
+    if (FieldLocationsByIndex.IsValidIndex(Index)) {
         // Spawn the chess piece on the appropriate tile.
-        AChessPiece* SpawnedChessPiece = SpawnChessPieceBasedOnFENChar(FENChar, FieldLocation);
+        AChessPiece* SpawnedChessPiece = SpawnChessPieceBasedOnFENChar(FENChar, FieldLocationsByIndex[Index]);
         return SpawnedChessPiece;
     }
     else {
-        // Log a warning if no chess tile was found for the field name.
-        //UE_LOG(LogTemp, Error, TEXT("No location found for field name: %s"), *FieldName);
+        // Log a warning if no chess tile was found for the board index.
+        //UE_LOG(LogTemp, Error, TEXT("No location found for board index: %d"), Index);
         return NULL;
     }
-}
\ No newline at end of file
+}
+
+// Returns the location of a field by its board index (0 = a8 ... 63 = h1)
+FVector AChessBoard::GetFieldLocation(int Index) const {
+    return FieldLocationsByIndex.IsValidIndex(Index) ? FieldLocationsByIndex[Index] : FVector::ZeroVector;
+}
+
+// Moves a chess piece onto a field and turns it towards the opponent
+void AChessBoard::PlaceChessPiece(AChessPiece* ChessPiece, char FENChar, int Index) {
+    const bool IsWhite = FChar::IsUpper(FENChar);
+    const FRotator LookDirection = IsWhite ? FRotator(0.0f, 0.0f, 0.0f) : FRotator(0.0f, 180.0f, 0.0f);  // Black pieces face the opposite direction.
+    ChessPiece->SetActorLocationAndRotation(GetFieldLocation(Index) + PieceOffset, LookDirection);
+}
+
+// Takes a chess piece from the pool, or spawns one if no pooled piece of the right class exists
+AChessPiece* AChessBoard::AcquireChessPiece(char FENChar, int Index) {
+    const FString FENString = FString::Chr(FENChar);
+    TSubclassOf<AChessPiece>* ChessPieceClassPointer = ChessPieceClasses.Find(FENString);
+    if (!ChessPieceClassPointer || !*ChessPieceClassPointer) {
+        return NULL;  // No chess piece class for this FEN character.
+    }
+
+    // Reuse the most recently pooled piece of the same class
+    for (int PoolIndex = PooledPieces.Num() - 1; PoolIndex >= 0; PoolIndex--) {
+        AChessPiece* PooledPiece = PooledPieces[PoolIndex];
+        if (IsValid(PooledPiece) && (PooledPiece->GetClass() == ChessPieceClassPointer->Get())) {
+            PooledPieces.RemoveAtSwap(PoolIndex);
+
+            // Set the color again, since white and black pieces may share a class
+            PooledPiece->SetColorMaterial(FChar::IsUpper(FENChar) ? LightColor : DarkColor);
+            PlaceChessPiece(PooledPiece, FENChar, Index);
+            PooledPiece->SetActorHiddenInGame(false);
+            PooledPiece->SetActorEnableCollision(true);
+            return PooledPiece;
+        }
+    }
+
+    // The pool has no matching piece, so spawn a new one
+    return SpawnChessPieceBasedOnFENChar(FENString, GetFieldLocation(Index));
+}
+
+// Hides a chess piece and keeps it for later reuse
+void AChessBoard::ReleaseChessPiece(AChessPiece* ChessPiece) {
+    if (!IsValid(ChessPiece)) {
+        return;
+    }
+
+    ChessPiece->SetActorHiddenInGame(true);
+    ChessPiece->SetActorEnableCollision(false);
+    PooledPieces.Add(ChessPiece);
+}
+
+// Updates the pieces on the board to match the FEN string, touching only the fields that changed
+void AChessBoard::UpdateBoardFromFEN(const FString& FEN) {
+    FTCHARToUTF8 FENString(*FEN);
+    ChessPosition Position;
+    FENParser::parseFEN(std::string_view(FENString.Get(), FENString.Length()), Position);
+
+    // Instanced pieces only need their instances updated
+    if (PieceInstanceComponents.Num() == CHESS_PIECE_TYPE_COUNT) {
+        UpdateInstancedPieces(Position.pieces);
+        return;
+    }
+
+    // Compute the moves, captures and promotions between the current and the new placement
+    const std::vector<ChessBoardChange> Changes = computeBoardDiff(CurrentPlacement, Position.pieces);
+
+    // Lift all moving pieces off their fields first, so a piece never lands on a field another piece is still leaving
+    TArray<AChessPiece*, TInlineAllocator<8>> MovingPieces;
+    for (const ChessBoardChange& Change : Changes) {
+        if (Change.type == ChessBoardChangeType::Remove) {
+            ReleaseChessPiece(PiecesOnBoard[Change.fromIndex]);  // Captured or promoted pieces go back into the pool
+            PiecesOnBoard[Change.fromIndex] = nullptr;
+        }
+        else if (Change.type == ChessBoardChangeType::Move) {
+            MovingPieces.Add(PiecesOnBoard[Change.fromIndex]);
+            PiecesOnBoard[Change.fromIndex] = nullptr;
+        }
+    }
+
+    // Relocate the moved pieces and fill the new fields from the pool
+    int MovingPieceIndex = 0;
+    for (const ChessBoardChange& Change : Changes) {
+        if (Change.type == ChessBoardChangeType::Move) {
+            AChessPiece* ChessPiece = MovingPieces[MovingPieceIndex++];
+            if (IsValid(ChessPiece)) {
+                PlaceChessPiece(ChessPiece, Change.piece, Change.toIndex);
+            }
+            else {
+                ChessPiece = AcquireChessPiece(Change.piece, Change.toIndex);  // The piece was destroyed elsewhere
+            }
+            PiecesOnBoard[Change.toIndex] = ChessPiece;
+        }
+        else if (Change.type == ChessBoardChangeType::Add) {
+            PiecesOnBoard[Change.toIndex] = AcquireChessPiece(Change.piece, Change.toIndex);
+        }
+    }
+
+    FMemory::Memcpy(CurrentPlacement, Position.pieces, sizeof(CurrentPlacement));
+}
+
+// Switches the board to one instanced mesh per piece type
+void AChessBoard::SetPieceInstanceComponents(UHierarchicalInstancedStaticMeshComponent* Pawns, UHierarchicalInstancedStaticMeshComponent* Knights,
+    UHierarchicalInstancedStaticMeshComponent* Bishops, UHierarchicalInstancedStaticMeshComponent* Rooks,
+    UHierarchicalInstancedStaticMeshComponent* Queens, UHierarchicalInstancedStaticMeshComponent* Kings) {
+    // Return the piece actors to the pool; the next UpdateBoardFromFEN adds every piece as an instance
+    for (AChessPiece*& ChessPiece : PiecesOnBoard) {
+        ReleaseChessPiece(ChessPiece);
+        ChessPiece = nullptr;
+    }
+    FMemory::Memset(CurrentPlacement, '.', sizeof(CurrentPlacement));
+
+    // Same order as ChessPieceInstanceMap::pieceType ("pnbrqk")
+    PieceInstanceComponents = { Pawns, Knights, Bishops, Rooks, Queens, Kings };
+    for (UHierarchicalInstancedStaticMeshComponent* Component : PieceInstanceComponents) {
+        if (!Component) {
+            PieceInstanceComponents.Reset();  // All six meshes are needed; keep using actors otherwise
+            break;
+        }
+    }
+    for (UHierarchicalInstancedStaticMeshComponent* Component : PieceInstanceComponents) {
+        Component->ClearInstances();
+        Component->SetNumCustomDataFloats(1);  // Color of the piece
+        Component->SetComponentTickEnabled(false);
+    }
+    PieceInstances.reset();
+}
+
+// Applies the instance updates of a new placement, marking each mesh's render state dirty only once
+void AChessBoard::UpdateInstancedPieces(const char (&Placement)[64]) {
+    const std::vector<ChessPieceInstanceUpdate> Updates = PieceInstances.update(Placement);
+    bool Changed[CHESS_PIECE_TYPE_COUNT] = {};
+
+    for (const ChessPieceInstanceUpdate& Update : Updates) {
+        UHierarchicalInstancedStaticMeshComponent* Component = PieceInstanceComponents[Update.pieceType];
+
+        // Hidden instances shrink to nothing on their last field, so their indices stay valid for reuse
+        FTransform InstanceTransform = FTransform::Identity;
+        if (Update.boardIndex >= 0) {
+            const FRotator LookDirection = Update.white ? FRotator(0.0f, 0.0f, 0.0f) : FRotator(0.0f, 180.0f, 0.0f);  // Black pieces face the opposite direction.
+            InstanceTransform = FTransform(LookDirection, GetFieldLocation(Update.boardIndex) + PieceOffset, FVector(1.0f));
+        }
+        else {
+            Component->GetInstanceTransform(Update.instance, InstanceTransform);
+            InstanceTransform.SetScale3D(FVector::ZeroVector);
+        }
+
+        if (Update.created) {
+            Component->AddInstance(InstanceTransform);
+        }
+        else {
+            Component->UpdateInstanceTransform(Update.instance, InstanceTransform, false, false, true);
+        }
+        Component->SetCustomDataValue(Update.instance, 0, Update.white ? 0.0f : 1.0f, false);
+        Changed[Update.pieceType] = true;
+    }
+
+    for (int PieceType = 0; PieceType < CHESS_PIECE_TYPE_COUNT; PieceType++) {
+        if (Changed[PieceType]) {
+            PieceInstanceComponents[PieceType]->MarkRenderStateDirty();
+        }
+    }
+    FMemory::Memcpy(CurrentPlacement, Placement, sizeof(CurrentPlacement));
+}
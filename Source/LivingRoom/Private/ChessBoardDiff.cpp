@@ -0,0 +1,66 @@
+#include "ChessBoardDiff.h"  // Declares computeBoardDiff and the ChessBoardChange struct.
+#include <cstdlib>           // Provides std::abs for measuring distances between squares.
+
+// Distance between two squares (0 = a8 ... 63 = h1), used to pair up vacated and filled squares
+static int squareDistance(int firstIndex, int secondIndex) {
+    return std::abs(firstIndex / 8 - secondIndex / 8) + std::abs(firstIndex % 8 - secondIndex % 8);
+}
+
+// Computes the changes between two piece placements
+std::vector<ChessBoardChange> computeBoardDiff(const char (&before)[64], const char (&after)[64]) {
+    // Squares whose piece left and squares that received a new piece
+    int vacated[64];
+    int filled[64];
+    int vacatedCount = 0;
+    int filledCount = 0;
+
+    for (int index = 0; index < 64; ++index) {
+        if (before[index] == after[index]) {
+            continue;  // Unchanged square
+        }
+        if (before[index] != '.') {
+            vacated[vacatedCount++] = index;
+        }
+        if (after[index] != '.') {
+            filled[filledCount++] = index;
+        }
+    }
+
+    std::vector<ChessBoardChange> moves;
+    std::vector<ChessBoardChange> additions;
+    moves.reserve(filledCount);
+
+    // Pair every filled square with the closest vacated square that held the same piece
+    for (int filledIndex = 0; filledIndex < filledCount; ++filledIndex) {
+        const int toIndex = filled[filledIndex];
+        int bestVacated = -1;
+
+        for (int vacatedIndex = 0; vacatedIndex < vacatedCount; ++vacatedIndex) {
+            const int fromIndex = vacated[vacatedIndex];
+            if ((fromIndex >= 0) && (before[fromIndex] == after[toIndex])
+                && ((bestVacated < 0) || (squareDistance(fromIndex, toIndex) < squareDistance(vacated[bestVacated], toIndex)))) {
+                bestVacated = vacatedIndex;
+            }
+        }
+
+        if (bestVacated >= 0) {
+            moves.push_back({ ChessBoardChangeType::Move, after[toIndex], static_cast<std::int8_t>(vacated[bestVacated]), static_cast<std::int8_t>(toIndex) });
+            vacated[bestVacated] = -1;  // Each vacated square provides only one piece
+        }
+        else {
+            additions.push_back({ ChessBoardChangeType::Add, after[toIndex], -1, static_cast<std::int8_t>(toIndex) });
+        }
+    }
+
+    // Pieces left on unmatched vacated squares were captured or promoted
+    std::vector<ChessBoardChange> changes;
+    changes.reserve(vacatedCount + additions.size());
+    for (int vacatedIndex = 0; vacatedIndex < vacatedCount; ++vacatedIndex) {
+        if (vacated[vacatedIndex] >= 0) {
+            changes.push_back({ ChessBoardChangeType::Remove, before[vacated[vacatedIndex]], static_cast<std::int8_t>(vacated[vacatedIndex]), -1 });
+        }
+    }
+    changes.insert(changes.end(), moves.begin(), moves.end());
+    changes.insert(changes.end(), additions.begin(), additions.end());
+    return changes;
+}
@@ -0,0 +1,104 @@
+#include "ChessMove.h"  // Declares the ChessMove struct, a move in Stockfish's packed 16-bit encoding.
+#include "FENParser.h"  // Declares the ChessPosition struct that UCI moves are decoded against.
+#include <cctype>       // Provides std::tolower and std::toupper for promotion pieces.
+#include <cstdlib>      // Provides std::abs for the distance a king moves.
+#include <string>       // Provides std::string for the UCI notation of a move.
+
+// Castling is stored as "king takes rook"; the king really lands on the g-file (kingside) or c-file (queenside)
+int ChessMove::kingDestinationSquare() const {
+    if (!isCastling()) {
+        return toSquare();
+    }
+    const int rank = fromSquare() / 8;
+    const int file = toSquare() > fromSquare() ? 6 : 2;
+    return rank * 8 + file;
+}
+
+// Converts the move into UCI notation, the format Stockfish prints and reads
+std::string ChessMove::toUCI() const {
+    std::string move = squareName(fromSquare()) + squareName(kingDestinationSquare());
+    if (isPromotion()) {
+        move += promotionPiece();
+    }
+    return move;
+}
+
+// Returns the square index (a1 = 0) of a square name like "e4", or -1 if the text is no square
+static int parseSquare(char file, char rank) {
+    if (file < 'a' || file > 'h' || rank < '1' || rank > '8') {
+        return -1;
+    }
+    return (rank - '1') * 8 + (file - 'a');
+}
+
+// Decodes a UCI move; castling becomes "king takes rook" and en passant is recognized from the position
+ChessMove ChessMove::fromUCI(std::string_view uci, const ChessPosition& position) {
+    if (uci.size() < 4) {
+        return ChessMove();
+    }
+    const int from = parseSquare(uci[0], uci[1]);
+    const int to = parseSquare(uci[2], uci[3]);
+    if (from < 0 || to < 0 || from == to) {
+        return ChessMove();
+    }
+
+    const char piece = position.pieces[ChessPosition::toBitboardSquare(from)];
+    const char target = position.pieces[ChessPosition::toBitboardSquare(to)];
+    const bool white = piece >= 'A' && piece <= 'Z';
+
+    // A king moving two files, or onto its own rook, castles
+    if (piece == 'K' || piece == 'k') {
+        const char ownRook = white ? 'R' : 'r';
+        if (target == ownRook) {
+            return ChessMove(static_cast<std::uint16_t>(static_cast<std::uint16_t>(ChessMoveType::Castling) | (from << 6) | to));
+        }
+        if (std::abs(to % 8 - from % 8) == 2) {
+            const int rookSquare = (from / 8) * 8 + (to > from ? 7 : 0);
+            return ChessMove(static_cast<std::uint16_t>(static_cast<std::uint16_t>(ChessMoveType::Castling) | (from << 6) | rookSquare));
+        }
+    }
+
+    // A pawn moving onto the en passant square captures en passant
+    if ((piece == 'P' || piece == 'p') && to == position.enPassantSquare) {
+        return ChessMove(static_cast<std::uint16_t>(static_cast<std::uint16_t>(ChessMoveType::EnPassant) | (from << 6) | to));
+    }
+
+    if (uci.size() >= 5) {
+        const char promotion = static_cast<char>(std::tolower(static_cast<unsigned char>(uci[4])));
+        const std::string_view promotionPieces = "nbrq";
+        const size_t promotionIndex = promotionPieces.find(promotion);
+        if (promotionIndex != std::string_view::npos) {
+            return ChessMove(static_cast<std::uint16_t>(static_cast<std::uint16_t>(ChessMoveType::Promotion)
+                | (promotionIndex << 12) | (from << 6) | to));
+        }
+    }
+
+    return ChessMove(static_cast<std::uint16_t>((from << 6) | to));
+}
+
+// Converts the move into the annotated notation of the game's Blueprints
+std::string ChessMove::toGameNotation() const {
+    const int from = fromSquare();
+    const int to = toSquare();
+
+    if (isCastling()) {
+        const int rank = from / 8;
+        const int rookDestination = rank * 8 + (to > from ? 5 : 3);  // f-file or d-file
+        return squareName(from) + squareName(kingDestinationSquare()) + "|" + squareName(to) + squareName(rookDestination);
+    }
+    if (isEnPassant()) {
+        const int capturedPawn = (from / 8) * 8 + to % 8;  // Beside the pawn, on the file it moves to
+        return squareName(from) + squareName(to) + "-" + squareName(capturedPawn);
+    }
+    if (isPromotion()) {
+        const bool white = to / 8 == 7;  // White promotes on the 8th rank
+        const char piece = white ? static_cast<char>(std::toupper(static_cast<unsigned char>(promotionPiece()))) : promotionPiece();
+        return squareName(from) + squareName(to) + "->" + piece;
+    }
+    return squareName(from) + squareName(to);
+}
+
+// Converts a square index (a1 = 0 ... h8 = 63) into its algebraic name
+std::string ChessMove::squareName(int square) {
+    return std::string{ static_cast<char>('a' + square % 8), static_cast<char>('1' + square / 8) };
+}
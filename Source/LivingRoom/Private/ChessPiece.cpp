@@ -2,13 +2,14 @@
 
 
 #include "ChessPiece.h"
+#include "GameFramework/CharacterMovementComponent.h"  // Character movement, which a chess piece placed by the board never uses
 
 // Sets default values
 AChessPiece::AChessPiece()
 {
- 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
-
+	// Pieces are only moved by AChessBoard, so neither the actor nor its character movement needs to tick
+	PrimaryActorTick.bCanEverTick = false;
+	GetCharacterMovement()->PrimaryComponentTick.bCanEverTick = false;
 }
 
 // Called when the game starts or when spawned
@@ -18,13 +19,6 @@ void AChessPiece::BeginPlay()
 	
 }
 
-// Called every frame
-void AChessPiece::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-
-}
-
 // Called to bind functionality to input
 void AChessPiece::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 {
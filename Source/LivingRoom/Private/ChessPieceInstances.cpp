@@ -0,0 +1,91 @@
+#include "ChessPieceInstances.h"  // Declares the ChessPieceInstanceMap class mapping squares to mesh instances.
+#include "ChessBoardDiff.h"       // Declares computeBoardDiff, which finds the pieces that moved, left or arrived.
+#include <algorithm>              // Provides std::fill for resetting the arrays.
+#include <cctype>                 // Provides std::tolower for mapping both colors to the same piece type.
+#include <cstring>                // Provides std::strchr for looking up piece characters.
+#include <iterator>               // Provides std::begin and std::end for the fixed-size arrays.
+
+ChessPieceInstanceMap::ChessPieceInstanceMap() {
+    reset();
+}
+
+// Pawn, knight, bishop, rook, queen and king of either color
+int ChessPieceInstanceMap::pieceType(char fenChar) {
+    static const char pieceTypes[] = "pnbrqk";
+    const char lowerCase = static_cast<char>(std::tolower(static_cast<unsigned char>(fenChar)));
+    const char* type = (lowerCase != '\0') ? std::strchr(pieceTypes, lowerCase) : nullptr;
+    return type ? static_cast<int>(type - pieceTypes) : -1;
+}
+
+// Turns the changes between the current and the new placement into instance updates
+std::vector<ChessPieceInstanceUpdate> ChessPieceInstanceMap::update(const char (&placement)[64]) {
+    const std::vector<ChessBoardChange> changes = computeBoardDiff(currentPlacement, placement);
+    std::vector<ChessPieceInstanceUpdate> updates;
+    updates.reserve(changes.size());
+
+    // Lift all pieces that move or leave first, like AChessBoard does with its actors
+    std::int16_t movingInstances[64];
+    int movingCount = 0;
+    for (const ChessBoardChange& change : changes) {
+        const int type = pieceType(change.piece);
+        if (type < 0 || change.type == ChessBoardChangeType::Add) {
+            continue;  // Unknown FEN characters never get an instance; new pieces are placed below
+        }
+        const std::int16_t instance = instanceOnSquare[change.fromIndex];
+        if (change.type == ChessBoardChangeType::Remove) {
+            hiddenInstances[type].push_back(instance);  // Captured or promoted: hide the instance and keep it for reuse
+            updates.push_back({ static_cast<std::int8_t>(type), instance, -1, std::isupper(static_cast<unsigned char>(change.piece)) != 0, false });
+            instanceOnSquare[change.fromIndex] = -1;
+        }
+        else if (change.type == ChessBoardChangeType::Move) {
+            movingInstances[movingCount++] = instance;
+            instanceOnSquare[change.fromIndex] = -1;
+        }
+    }
+
+    // Put the moving pieces down, then give each new piece a hidden or a new instance
+    int movingIndex = 0;
+    for (const ChessBoardChange& change : changes) {
+        const int type = pieceType(change.piece);
+        if (type < 0 || change.type == ChessBoardChangeType::Remove) {
+            continue;
+        }
+
+        ChessPieceInstanceUpdate instanceUpdate = { static_cast<std::int8_t>(type), 0, change.toIndex,
+            std::isupper(static_cast<unsigned char>(change.piece)) != 0, false };
+        if (change.type == ChessBoardChangeType::Move) {
+            instanceUpdate.instance = movingInstances[movingIndex++];
+        }
+        else if (!hiddenInstances[type].empty()) {
+            instanceUpdate.instance = hiddenInstances[type].back();
+            hiddenInstances[type].pop_back();
+        }
+        else {
+            instanceUpdate.instance = static_cast<std::int16_t>(instanceCounts[type]++);
+            instanceUpdate.created = true;
+        }
+        instanceOnSquare[change.toIndex] = instanceUpdate.instance;
+        updates.push_back(instanceUpdate);
+    }
+
+    std::copy(std::begin(placement), std::end(placement), std::begin(currentPlacement));
+    return updates;
+}
+
+int ChessPieceInstanceMap::instanceAt(int boardIndex) const {
+    return (boardIndex >= 0 && boardIndex < 64) ? instanceOnSquare[boardIndex] : -1;
+}
+
+int ChessPieceInstanceMap::instanceCount(int type) const {
+    return (type >= 0 && type < CHESS_PIECE_TYPE_COUNT) ? instanceCounts[type] : 0;
+}
+
+// Start with an empty board and no instances
+void ChessPieceInstanceMap::reset() {
+    std::fill(std::begin(currentPlacement), std::end(currentPlacement), '.');
+    std::fill(std::begin(instanceOnSquare), std::end(instanceOnSquare), static_cast<std::int16_t>(-1));
+    std::fill(std::begin(instanceCounts), std::end(instanceCounts), 0);
+    for (std::vector<std::int16_t>& hidden : hiddenInstances) {
+        hidden.clear();
+    }
+}
@@ -0,0 +1,274 @@
+#include "EnginePool.h"  // Declares the EnginePool class, which hands out engine instances to concurrent requests.
+#include "Stockfish.h"   // Declares the Stockfish class, one engine (process or in-process) per pool slot.
+#include <algorithm>     // Provides std::max for the engine count.
+
+// Retrieve the single instance of the EnginePool class
+EnginePool& EnginePool::getInstance() {
+    static EnginePool instance;
+    return instance;
+}
+
+EnginePool::EnginePool() {
+    for (size_t slot = 0; slot < engineCount; ++slot) {
+        slots.emplace_back();
+        slots.back().engine = createEngine(slot);
+    }
+}
+
+EnginePool::Lease::Lease(Lease&& other) noexcept
+    : pool(other.pool), slot(other.slot), leasedEngine(std::move(other.leasedEngine)), board(other.board),
+      gameSession(std::move(other.gameSession)), gameGeneration(other.gameGeneration) {
+    other.pool = nullptr;
+}
+
+EnginePool::Lease::~Lease() {
+    if (pool) {
+        pool->release(*this);
+    }
+}
+
+Stockfish& EnginePool::Lease::engine() const {
+    return *leasedEngine;
+}
+
+GameSession& EnginePool::Lease::session() {
+    return gameSession;
+}
+
+// Create an engine for a slot; its process or engine instance only starts with the first request
+std::shared_ptr<Stockfish> EnginePool::createEngine(size_t slot) {
+    std::shared_ptr<Stockfish> engine = std::make_shared<Stockfish>(static_cast<int>(slot));
+    if (searchTimeBudget > 0) {
+        engine->setSearchTimeBudget(searchTimeBudget);
+    }
+    engine->setPondering(ponderingEnabled);
+    engine->setSharedMemoryTransport(sharedMemoryEnabled);
+    return engine;
+}
+
+// Wait in the queue until the scheduler assigns an engine, or until the request is cancelled
+EnginePool::Lease EnginePool::acquire(AIRequestPriority priority, int board, const AIRequestToken* token) {
+    std::unique_lock<std::mutex> lock(poolMutex);
+
+    Ticket ticket{ priority, nextSequence++, std::max(0, board), token };
+    waiting.push_back(&ticket);
+    dispatch();
+    engineReleased.wait(lock, [&ticket]() { return ticket.slot != SIZE_MAX || (ticket.request && ticket.request->cancelled); });
+
+    if (ticket.slot == SIZE_MAX) {
+        waiting.remove(&ticket);
+        return Lease(nullptr, SIZE_MAX, nullptr, ticket.board, GameSession(), 0);
+    }
+    const BoardGame& game = games[ticket.board];
+    return Lease(this, ticket.slot, slots[ticket.slot].engine, ticket.board, game.session, game.generation);
+}
+
+// Give free engines to waiting requests: interactive before background, then first come first served.
+// A request gets its board's own engine if that one is free, otherwise any free engine; the game session travels
+// with the lease, and a ponder search only answers requests continuing its own game.
+void EnginePool::dispatch() {
+    bool assigned = false;
+
+    while (!waiting.empty()) {
+        auto best = waiting.begin();
+        for (auto candidate = waiting.begin(); candidate != waiting.end(); ++candidate) {
+            if ((*candidate)->priority < (*best)->priority
+                || ((*candidate)->priority == (*best)->priority && (*candidate)->sequence < (*best)->sequence)) {
+                best = candidate;
+            }
+        }
+
+        Ticket& ticket = **best;
+        size_t slot = static_cast<size_t>(ticket.board) % engineCount;
+        if (slots[slot].busy) {
+            slot = SIZE_MAX;
+            for (size_t candidate = 0; candidate < engineCount; ++candidate) {
+                if (!slots[candidate].busy) {
+                    slot = candidate;
+                    break;
+                }
+            }
+        }
+        if (slot == SIZE_MAX) {
+            break;  // All engines are busy; the next release dispatches again
+        }
+
+        slots[slot].busy = true;
+        slots[slot].board = ticket.board;
+        slots[slot].request = ticket.request;
+        ticket.slot = slot;
+        waiting.erase(best);
+        assigned = true;
+    }
+
+    if (assigned) {
+        engineReleased.notify_all();
+    }
+}
+
+// Return an engine and hand it to the next waiting request; retired engines are closed instead.
+// Of two leases of the same board, the one released last leaves its session; both saw the same game.
+void EnginePool::release(Lease& lease) {
+    const size_t slot = lease.slot;
+    std::vector<std::shared_ptr<Stockfish>> retired;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        BoardGame& game = games[lease.board];
+        if (game.generation == lease.gameGeneration) {
+            game.session = std::move(lease.gameSession);
+        }
+        slots[slot].busy = false;
+        slots[slot].board = -1;
+        slots[slot].request = nullptr;
+        retired = retireEngines();
+        dispatch();
+    }
+
+    for (const std::shared_ptr<Stockfish>& engine : retired) {
+        engine->closeStockfish();
+    }
+}
+
+std::vector<std::shared_ptr<Stockfish>> EnginePool::retireEngines() {
+    std::vector<std::shared_ptr<Stockfish>> retired;
+    while (slots.size() > engineCount && !slots.back().busy) {
+        retired.push_back(slots.back().engine);
+        slots.pop_back();
+    }
+    return retired;
+}
+
+std::vector<std::shared_ptr<Stockfish>> EnginePool::allEngines() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    std::vector<std::shared_ptr<Stockfish>> engines;
+    for (const Slot& slot : slots) {
+        engines.push_back(slot.engine);
+    }
+    return engines;
+}
+
+// Grow or shrink the pool; busy engines beyond the new count finish their request first
+void EnginePool::setEngineCount(int count) {
+    std::vector<std::shared_ptr<Stockfish>> retired;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        engineCount = static_cast<size_t>(std::max(1, count));
+        for (size_t slot = slots.size(); slot < engineCount; ++slot) {
+            slots.emplace_back();
+            slots.back().engine = createEngine(slot);
+        }
+        retired = retireEngines();
+        dispatch();
+    }
+
+    for (const std::shared_ptr<Stockfish>& engine : retired) {
+        engine->closeStockfish();
+    }
+}
+
+int EnginePool::getEngineCount() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return static_cast<int>(engineCount);
+}
+
+// Stop the searches of one board, or all of them
+void EnginePool::stop(int board) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    for (Slot& slot : slots) {
+        if (slot.busy && (board < 0 || slot.board == board)) {
+            slot.engine->stopStockfish();
+        }
+    }
+}
+
+// Stop the search of one request; a request still waiting for an engine wakes up and leaves the queue
+void EnginePool::cancel(const AIRequestToken* token) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    for (Slot& slot : slots) {
+        if (slot.busy && slot.request == token) {
+            slot.engine->stopRequest(token);
+        }
+    }
+    engineReleased.notify_all();
+}
+
+// Warm up every engine in turn; requests arriving meanwhile wait for the engine being warmed up
+void EnginePool::prewarm(const int& skillLevel) {
+    for (int slot = 0; slot < getEngineCount(); ++slot) {
+        Lease lease = acquire(AIRequestPriority::Background, slot);
+        lease.engine().prewarmStockfish(skillLevel);
+    }
+}
+
+void EnginePool::startNewGame(int board) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (board >= 0) {
+        games[board].session.startNewGame();
+        ++games[board].generation;
+        return;
+    }
+    for (auto& game : games) {
+        game.second.session.startNewGame();
+        ++game.second.generation;
+    }
+}
+
+void EnginePool::updateGameSession(int board, const std::string& fen) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    games[std::max(0, board)].session.update(fen);
+}
+
+SearchLimits EnginePool::limitsFor(const int& skillLevel) {
+    SearchLimitPolicy policy;  // The same policy every engine applies with this budget
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (searchTimeBudget > 0) {
+            policy.setTimeBudget(searchTimeBudget);
+        }
+    }
+    return policy.limitsFor(skillLevel);
+}
+
+void EnginePool::setSearchTimeBudget(const int& milliseconds) {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        searchTimeBudget = milliseconds;  // For engines added later
+    }
+    for (const std::shared_ptr<Stockfish>& engine : allEngines()) {
+        engine->setSearchTimeBudget(milliseconds);
+    }
+}
+
+void EnginePool::setPondering(const bool& enabled) {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        ponderingEnabled = enabled;  // For engines added later
+    }
+    for (const std::shared_ptr<Stockfish>& engine : allEngines()) {
+        engine->setPondering(enabled);
+    }
+}
+
+void EnginePool::setSharedMemoryTransport(const bool& enabled) {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        sharedMemoryEnabled = enabled;  // For engines added later
+    }
+    for (const std::shared_ptr<Stockfish>& engine : allEngines()) {
+        engine->setSharedMemoryTransport(enabled);
+    }
+}
+
+// Close every engine; a busy engine is stopped first and closed once its request returns
+void EnginePool::closeAll() {
+    for (const std::shared_ptr<Stockfish>& engine : allEngines()) {
+        engine->closeStockfish();
+    }
+}
+
+// Close the Stockfish processes the same way; the next request of each engine starts a new one
+void EnginePool::closeProcessEngines() {
+    for (const std::shared_ptr<Stockfish>& engine : allEngines()) {
+        engine->closeStockfishProcess();
+    }
+}
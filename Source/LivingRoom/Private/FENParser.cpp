@@ -1,260 +1,216 @@
 #include "FenParser.h"     // Includes the FENParser class, which has methods to parse and handle chess FEN strings.
-#include "ChessAIHandler.h" // Includes the ChessAIHandler class for managing AI logic and interacting with Stockfish.
+#include "ChessMove.h"       // Includes ChessMove::squareName for converting square indices into algebraic names.
+#include <algorithm>       // Includes std::equal and std::fill for the piece array.
 #include <cctype>          // Includes functions like std::isdigit to check if a character is a digit.
+#include <cstring>         // Includes std::strchr for looking up piece characters.
 #include <iostream>        // Includes standard input/output functions, like std::cout for debugging.
-#include <sstream>         // Includes std::istringstream for splitting strings, such as the FEN string.
+#include <iterator>        // Includes std::begin and std::end for the fixed-size piece array.
 #include <string>          // Includes the std::string class for handling text strings.
+#include <string_view>     // Includes std::string_view for reading the FEN string without copying it.
 #include <vector>          // Includes std::vector for dynamic arrays, useful for storing data like board rows or legal moves.
 
 using namespace std;
 
-const std::string COLUMN_LETTERS = "abcdefgh"; // String representing column letters used in chess notation.
-
 //----------------------------------------- Simple Parser ----------------------------------------------------
 
-// Forward declaration of helper function
-std::vector<bool> getCastlingAvailability(const std::string& castlingRights);
-
-//Read the input string and split it into parts based on the delimiter
-vector<string> splitStringIntoParts(const std::string& input, const char delimiter) {
-    istringstream stringStream(input); // Create a stream from the input string for easy parsing.
-    vector<string> parts; // This will store the resulting parts of the string.
-    string part; // Temporary variable to hold each part of the string.
+// Starting position, used when a FEN string cannot be parsed
+constexpr std::string_view START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 
-    // Read each part of the string up to the delimiter and store it in 'part'.
-    while (getline(stringStream, part, delimiter))
+// Splits off the next space-separated field of a FEN string without copying it
+std::string_view nextFENField(std::string_view& fen)
+{
+    size_t fieldStart = fen.find_first_not_of(' '); // Skip the separating spaces
+    if (fieldStart == std::string_view::npos)
     {
-        parts.push_back(part); // Add the current part to the vector of parts.
+        fen = std::string_view();
+        return std::string_view(); // No fields left
     }
 
-    return parts; // Return the list of parts.
+    fen.remove_prefix(fieldStart);
+    std::string_view field = fen.substr(0, fen.find(' '));
+    fen.remove_prefix(field.size()); // Continue after the field
+    return field;
 }
 
-// Parses a FEN string and extracts chess board state and other details.
-void FENParser::parseFEN(const std::string& fen, std::vector<std::string>& board, bool& whitesTurn,
-    std::vector<bool>& castlingRights, std::string& enPassantTarget,
-    int& halfMoveClock, int& fullMoveNumber) {
-    std::string fenString = fen; // Copy of the FEN string
-    std::istringstream fenStream(fenString); // Stream to read parts of the FEN string
-    std::vector<std::string> parts; // Stores the parts of the FEN string
-    std::string part;
-
-    // Split the FEN string into 6 parts using space as the delimiter.
-    parts = splitStringIntoParts(fen, ' ');
-
-    // Check if the FEN string has exactly 6 parts (board, turn, castling rights, en passant, half-move clock, full-move number).
-    if (parts.size() != 6) {
-        // If the input FEN is invalid, use a default FEN for the starting chess position.
-        fenString = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
-        parts = splitStringIntoParts(fenString, ' ');
+// Converts a FEN field consisting of digits into a number
+bool parseFENNumber(std::string_view field, int& number)
+{
+    if (field.empty() || field.size() > 6)
+    {
+        return false; // Empty or unreasonably large numbers are invalid
     }
 
-    // The first part of the FEN represents the board, with rows separated by '/'.
-    vector<string> rows = splitStringIntoParts(parts[0], '/');
-
-    // Convert FEN rows to board representation
-    for (const string& row : rows)
+    number = 0;
+    for (char digit : field)
     {
-        for (char currentFENChar : row)
+        if (!isdigit(static_cast<unsigned char>(digit)))
         {
-            if (isdigit(currentFENChar))
-            {
-                // If the character is a digit, it represents empty squares
-                int emptySquares = currentFENChar - '0'; // Convert character to number
-                for (int j = 0; j < emptySquares; ++j)
-                {
-                    board.push_back("."); // Add empty square to the board
-                }
-            }
-            else
-            {
-                board.push_back(string(1, currentFENChar)); // Add piece to the board
-            }
+            return false; // Only digits are allowed
         }
+        number = number * 10 + (digit - '0');
     }
-
-    // Extract other FEN details
-    whitesTurn = (parts[1] == "w"); // Determine whose turn it is
-    castlingRights = getCastlingAvailability(parts[2]); // Get castling rights
-    enPassantTarget = parts[3]; // Get en passant target
-    halfMoveClock = stoi(parts[4]); // Get half-move clock (number of half-moves since last capture or pawn move)
-    fullMoveNumber = stoi(parts[5]); // Get full-move number (total number of moves)
-}
-
-// Function to get castling rights from a string
-std::vector<bool> getCastlingAvailability(const std::string& castlingRights)
-{
-    std::vector<bool> castlingAvailability = { false, false, false, false }; // Initial castling rights (all false)
-
-    // Check each castling right and update the vector
-    castlingAvailability[0] = (castlingRights.find('K') != std::string::npos); // White Kingside
-    castlingAvailability[1] = (castlingRights.find('Q') != std::string::npos); // White Queenside
-    castlingAvailability[2] = (castlingRights.find('k') != std::string::npos); // Black Kingside
-    castlingAvailability[3] = (castlingRights.find('q') != std::string::npos); // Black Queenside
-
-    return castlingAvailability; // Return the vector of castling rights
-}
-
-//----------------------------------------- Advanced Chess Rules ----------------------------------------------------
-
-// Forward declarations of helper functions
-bool isSquareUnderAttack(const std::vector<std::string>& negativeLegalMoves, int row, int col);
-void removeStringFromVector(std::vector<std::string>& vec, const std::string& toRemove);
-std::vector<std::string> buildNegativeLegalMoves(const std::string& fen, bool whitesTurn);
-
-void FENParser::extractFENDetails(const std::string& fen, std::vector<std::string>& legalMoves, bool& drawOfferable)
-{
-    std::vector<std::string> board;
-    bool whitesTurn;
-    std::vector<bool> castlingRights;
-    std::string enPassantTarget;
-    int halfMoveClock;
-    int fullMoveNumber;
-
-    parseFEN(fen, board, whitesTurn, castlingRights, enPassantTarget, halfMoveClock, fullMoveNumber);
-    detectPossibleCastlingMoves(fen, legalMoves, board, whitesTurn, castlingRights);
-    detectEnPassant(legalMoves, board, enPassantTarget, whitesTurn);
-    drawOfferable = (halfMoveClock >= 100); // Check if a draw can be offered based on half-move clock
+    return true;
 }
 
-// Removes a specific string from a vector
-void removeStringFromVector(std::vector<std::string>& vec, const std::string& toRemove)
+// Fills the position from the six fields of a FEN string, returns false if any field is malformed
+bool parseFENFields(std::string_view fen, ChessPosition& position)
 {
-    // Move all instances of the string to the end of the vector
-    auto newEnd = std::remove(vec.begin(), vec.end(), toRemove);
-    vec.erase(newEnd, vec.end()); // Remove the moved elements
-}
+    position = ChessPosition();
+    std::fill(std::begin(position.pieces), std::end(position.pieces), '.');
+
+    // Split the FEN string into its 6 fields (board, turn, castling rights, en passant, half-move clock, full-move number)
+    std::string_view placement = nextFENField(fen);
+    std::string_view turn = nextFENField(fen);
+    std::string_view castling = nextFENField(fen);
+    std::string_view enPassant = nextFENField(fen);
+    std::string_view halfMoveClock = nextFENField(fen);
+    std::string_view fullMoveNumber = nextFENField(fen);
+    if (fullMoveNumber.empty() || !nextFENField(fen).empty())
+    {
+        return false; // A FEN string has exactly 6 fields
+    }
 
-// Checks if a square is attacked by any move in the list
-bool isSquareUnderAttack(const std::vector<std::string>& negativeLegalMoves, int row, int col)
-{
-    for (const std::string& move : negativeLegalMoves)
+    // Convert the FEN rows (separated by '/', starting with rank 8) into the piece array and bitboards
+    int row = 0;
+    int column = 0;
+    for (char currentFENChar : placement)
     {
-        if (move.substr(2, 2) == (COLUMN_LETTERS[col] + std::to_string(row + 1)))
+        if (currentFENChar == '/')
+        {
+            if ((column != 8) || (++row > 7))
+            {
+                return false; // Every row must describe exactly 8 squares, and there are only 8 rows
+            }
+            column = 0;
+        }
+        else if ((currentFENChar >= '1') && (currentFENChar <= '8'))
         {
-            return true; // Square is under attack
+            column += currentFENChar - '0'; // A digit represents that many empty squares
+            if (column > 8)
+            {
+                return false;
+            }
         }
-    }
-    return false; // Square is not under attack
-}
-
-// Builds a list of moves that could attack a square if the opponent were to move
-std::vector<std::string> buildNegativeLegalMoves(const std::string& fen, bool whitesTurn)
-{
-    ChessAIHandler chessAI;
-    std::string negativeFEN = fen;
-
-    // Switch the color in the FEN string to get the opponent's moves
-    std::string currentColor = whitesTurn ? "w" : "b";
-    int colorPosition = fen.find(currentColor);
-    negativeFEN[colorPosition] = (currentColor == "w" ? 'b' : 'w');
+        else
+        {
+            const char* piece = (currentFENChar != '\0') ? std::strchr(CHESS_PIECE_CHARACTERS, currentFENChar) : nullptr;
+            if ((piece == nullptr) || (column > 7))
+            {
+                return false; // Unknown piece or too many squares in this row
+            }
 
-    StockfishResponse response = chessAI.getChessAIFeedback(1, negativeFEN);
-    return response.legalMoves; // Return the list of legal moves for the opponent
-}
+            int boardIndex = row * 8 + column;
+            int pieceIndex = static_cast<int>(piece - CHESS_PIECE_CHARACTERS);
+            std::uint64_t squareBit = std::uint64_t(1) << ChessPosition::toBitboardSquare(boardIndex);
 
-// Detects possible castling moves based on board state and castling rights
-void FENParser::detectPossibleCastlingMoves(const std::string& fen, std::vector<std::string>& legalMoves,
-    std::vector<std::string> board, bool whitesTurn,
-    std::vector<bool> castlingRights)
-{
-    std::vector<std::string> negativeLegalMoves;
+            position.pieces[boardIndex] = currentFENChar;
+            position.pieceBitboards[pieceIndex] |= squareBit;
+            position.colorBitboards[pieceIndex / 6] |= squareBit; // White pieces come first
+            ++column;
+        }
+    }
 
-    // Check castling possibilities for the current side
-    if (whitesTurn)
+    if ((row != 7) || (column != 8))
     {
-        addCastlingOptionIfPossible(legalMoves, negativeLegalMoves, board, whitesTurn, castlingRights[0], true, "e1g1|h1f1"); // White Kingside
-        addCastlingOptionIfPossible(legalMoves, negativeLegalMoves, board, whitesTurn, castlingRights[1], false, "e1c1|a1d1"); // White Queenside
+        return false; // The board must have exactly 8 rows
     }
-    else
+
+    // Determine whose turn it is
+    if ((turn != "w") && (turn != "b"))
     {
-        addCastlingOptionIfPossible(legalMoves, negativeLegalMoves, board, whitesTurn, castlingRights[2], true, "e8g8|h8f8"); // Black Kingside
-        addCastlingOptionIfPossible(legalMoves, negativeLegalMoves, board, whitesTurn, castlingRights[3], false, "e8c8|a8d8"); // Black Queenside
+        return false;
     }
-}
-
-// Adds castling moves to the list if allowed
-void FENParser::addCastlingOptionIfPossible(std::vector<std::string>& legalMoves,
-    std::vector<std::string>& negativeLegalMoves,
-    const std::vector<std::string>& board, bool whitesTurn,
-    bool castlingAllowed, bool firstCastlingCheck,
-    const std::string& castlingMove)
-{
-    //Checks if the castling string is included in the legalMoves
-    bool castlingStringIncluded = (std::find(legalMoves.begin(), legalMoves.end(), castlingMove.substr(0, 4)) != legalMoves.end());
+    position.whitesTurn = (turn == "w");
 
-    if (castlingAllowed && castlingStringIncluded)
+    // Get castling rights
+    if (castling != "-")
     {
-        const int kingRow = whitesTurn ? 7 : 0; // Determine king's row based on color
-        int minColumn = firstCastlingCheck ? 5 : 1; // Columns to check for castling
-        int maxColumn = firstCastlingCheck ? 7 : 4;
-
-        // Check if the king is in check
-        if (isSquareUnderAttack(negativeLegalMoves, kingRow, 4))
-        {
-            castlingAllowed = false; // Castling is not allowed if king is in check
-        }
-
-        if (castlingAllowed)
+        for (char castlingRight : castling)
         {
-            // Check if squares between king and rook are empty and not attacked
-            for (int currentColumn = minColumn; currentColumn < maxColumn; currentColumn++)
+            switch (castlingRight)
             {
-                if ((board[kingRow * 8 + currentColumn] != ".") || isSquareUnderAttack(negativeLegalMoves, kingRow, currentColumn))
-                {
-                    castlingAllowed = false; // Castling is not allowed if any square is occupied or attacked
-                    break;
-                }
+            case 'K': position.castlingRights |= WhiteKingside; break;
+            case 'Q': position.castlingRights |= WhiteQueenside; break;
+            case 'k': position.castlingRights |= BlackKingside; break;
+            case 'q': position.castlingRights |= BlackQueenside; break;
+            default: return false;
             }
+        }
+    }
 
-            if (castlingAllowed)
-            {
-                removeStringFromVector(legalMoves, castlingMove.substr(0, 4)); // Remove any existing castling move
-                legalMoves.push_back(castlingMove); // Add the new castling move
-            }
+    // Get en passant target
+    if (enPassant != "-")
+    {
+        // The square behind a pawn that just moved two squares: rank 3 with black to move, rank 6 with white to move
+        const char enPassantRank = position.whitesTurn ? '6' : '3';
+        if ((enPassant.size() != 2) || (enPassant[0] < 'a') || (enPassant[0] > 'h') || (enPassant[1] != enPassantRank))
+        {
+            return false;
         }
+        position.enPassantSquare = static_cast<std::int8_t>((enPassant[1] - '1') * 8 + (enPassant[0] - 'a'));
     }
+
+    // Get half-move clock (number of half-moves since last capture or pawn move) and full-move number (total number of moves)
+    return parseFENNumber(halfMoveClock, position.halfMoveClock) && parseFENNumber(fullMoveNumber, position.fullMoveNumber);
 }
 
-// Detects en passant moves based on board state and en passant target
-void FENParser::detectEnPassant(std::vector<std::string>& legalMoves, const std::vector<std::string>& board,
-    const std::string& enPassantTarget, bool whitesTurn)
+// Parses a FEN string into a compact position without allocating memory
+bool FENParser::parseFEN(std::string_view fen, ChessPosition& position)
 {
-    bool enPassantPossible = (enPassantTarget != "-" && enPassantTarget.size() == 2);
+    if (parseFENFields(fen, position))
+    {
+        return true;
+    }
 
-    if (enPassantPossible)
+    // If the input FEN is invalid, use the starting chess position instead
+    parseFENFields(START_FEN, position);
+    return false;
+}
+
+// Compares the pieces, side to move and castling rights of two FEN strings
+bool FENParser::isSamePosition(std::string_view firstFEN, std::string_view secondFEN)
+{
+    ChessPosition first;
+    ChessPosition second;
+    if (!parseFENFields(firstFEN, first) || !parseFENFields(secondFEN, second))
     {
-        int targetColumn = COLUMN_LETTERS.find(enPassantTarget[0]); // Column of en passant target
-        int targetRow = 8 - std::stoi(enPassantTarget.substr(1, 1)); // Row of en passant target
+        return false;
+    }
 
-        // Check if the target square is empty
-        if (board[targetRow * 8 + targetColumn] != ".")
-        {
-            enPassantPossible = false; // En passant is not possible if target square is occupied
-        }
+    return first.isSamePosition(second);
+}
 
-        if (enPassantPossible)
-        {
-            int pawnRowDirection = whitesTurn ? 1 : -1; // Determine direction based on current turn
-            int adjacentRow = targetRow + pawnRowDirection;
-            std::string pawn = whitesTurn ? "P" : "p";
+// Compares the pieces, side to move and castling rights of two positions
+bool ChessPosition::isSamePosition(const ChessPosition& other) const
+{
+    return (std::equal(std::begin(pieces), std::end(pieces), std::begin(other.pieces)))
+        && (whitesTurn == other.whitesTurn) && (castlingRights == other.castlingRights);
+}
 
-            // Create en passant moves
-            std::string enPassantMoveAddon = enPassantTarget + "-" + enPassantTarget.substr(0, 1) + std::to_string(8 - adjacentRow);
+// Parses a FEN string and extracts chess board state and other details as strings.
+void FENParser::parseFEN(const std::string& fen, std::vector<std::string>& board, bool& whitesTurn,
+    std::vector<bool>& castlingRights, std::string& enPassantTarget,
+    int& halfMoveClock, int& fullMoveNumber) {
+    ChessPosition position;
+    parseFEN(std::string_view(fen), position);
 
-            // Adjust row and column indices for the board representation
-            if ((targetColumn > 0) && (board[(adjacentRow * 8) + (targetColumn - 1)] == pawn))
-            {
-                std::string startingField = COLUMN_LETTERS[targetColumn - 1] + std::to_string(8 - adjacentRow);
-                removeStringFromVector(legalMoves, startingField + enPassantTarget); // Remove old en passant move if it exists
-                legalMoves.push_back(startingField + enPassantMoveAddon); // Add new en passant move
-            }
-            else if ((targetColumn < 7) && (board[(adjacentRow * 8) + (targetColumn + 1)] == pawn))
-            {
-                std::string startingField = COLUMN_LETTERS[targetColumn + 1] + std::to_string(8 - adjacentRow);
-                removeStringFromVector(legalMoves, startingField + enPassantTarget); // Remove old en passant move if it exists
-                legalMoves.push_back(startingField + enPassantMoveAddon); // Add new en passant move
-            }
-        }
+    // Convert the piece array into the board representation
+    board.clear();
+    board.reserve(64);
+    for (char piece : position.pieces)
+    {
+        board.push_back(std::string(1, piece));
     }
-}
\ No newline at end of file
+
+    // Copy the other FEN details
+    whitesTurn = position.whitesTurn;
+    castlingRights = {
+        (position.castlingRights & WhiteKingside) != 0,
+        (position.castlingRights & WhiteQueenside) != 0,
+        (position.castlingRights & BlackKingside) != 0,
+        (position.castlingRights & BlackQueenside) != 0
+    };
+    enPassantTarget = (position.enPassantSquare < 0) ? "-" : ChessMove::squareName(position.enPassantSquare);
+    halfMoveClock = position.halfMoveClock;
+    fullMoveNumber = position.fullMoveNumber;
+}
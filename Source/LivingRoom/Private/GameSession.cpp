@@ -0,0 +1,151 @@
+#include "GameSession.h"     // Declares the GameSession class, which tracks the moves of the current game.
+#include "ChessBoardDiff.h"  // Provides computeBoardDiff for finding the pieces that moved between two positions.
+#include "ChessMove.h"       // Provides ChessMove::squareName for writing moves in UCI notation.
+#include <algorithm>         // Provides std::equal for comparing move lists.
+#include <cctype>            // Provides std::isupper and std::tolower for piece colors and promotion pieces.
+#include <string_view>       // Provides std::string_view for parsing FEN strings without copying them.
+
+// FEN string of the standard starting position, sent as "position startpos"
+const std::string START_POSITION_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Converts a board index of the piece array (0 = a8) into a square name (e.g. "e2")
+static std::string boardIndexName(int boardIndex) {
+    return ChessMove::squareName(ChessPosition::toBitboardSquare(boardIndex));
+}
+
+// Brings the session up to date with the position of a new request
+void GameSession::update(const std::string& fen) {
+    ChessPosition position;
+    const bool validFEN = FENParser::parseFEN(std::string_view(fen), position);
+    newGame = false;
+
+    if (hasPosition && validFEN && !newGamePending) {
+        if (position.isSamePosition(currentPosition)) {
+            return;  // The same position again (e.g. a repeated request), nothing was played
+        }
+
+        // One move later: only the new move is appended
+        const std::string move = findMove(currentPosition, position);
+        if (!move.empty()) {
+            moves.push_back(move);
+            currentPosition = position;
+            return;
+        }
+    }
+
+    // The position does not follow from the last one: start over from it. Returning to the starting position
+    // during a game means a new game was started.
+    ChessPosition startPosition;
+    FENParser::parseFEN(std::string_view(START_POSITION_FEN), startPosition);
+    const bool isStartPosition = validFEN && position.isSamePosition(startPosition) && (position.fullMoveNumber == 1);
+
+    newGame = newGamePending || (isStartPosition && hasPosition);
+    newGamePending = false;
+    startFEN = isStartPosition ? START_POSITION_FEN : fen;
+    moves.clear();
+    currentPosition = position;
+    hasPosition = true;
+}
+
+// Marks the beginning of a new game
+void GameSession::startNewGame() {
+    newGamePending = true;
+}
+
+// Returns true if the last update started a new game
+bool GameSession::isNewGame() const {
+    return newGame;
+}
+
+// Returns the position command for the current position and optional further moves
+std::string GameSession::positionCommand(const std::vector<std::string>& extraMoves) const {
+    std::string command = (startFEN == START_POSITION_FEN) ? "position startpos" : "position fen " + startFEN;
+
+    if (!moves.empty() || !extraMoves.empty()) {
+        command += " moves";
+        for (const std::string& move : moves) {
+            command += " " + move;
+        }
+        for (const std::string& move : extraMoves) {
+            command += " " + move;
+        }
+    }
+    return command;
+}
+
+const std::string& GameSession::getStartFEN() const {
+    return startFEN;
+}
+
+const std::vector<std::string>& GameSession::getMoves() const {
+    return moves;
+}
+
+bool GameSession::continues(const GameSession& earlier) const {
+    return hasPosition && earlier.hasPosition && !newGame && (startFEN == earlier.startFEN) && (moves.size() >= earlier.moves.size())
+        && std::equal(earlier.moves.begin(), earlier.moves.end(), moves.begin());
+}
+
+// Reconstructs the move between two positions from the pieces that changed
+std::string GameSession::findMove(const ChessPosition& before, const ChessPosition& after) {
+    if (before.whitesTurn == after.whitesTurn) {
+        return std::string();  // Exactly one move flips the side to move
+    }
+
+    const bool whiteMoved = before.whitesTurn;
+    int moverMoves = 0;     // Pieces of the moving side that changed squares
+    int moverRemoves = 0;   // Pieces of the moving side that left the board (a promoting pawn)
+    int moverAdds = 0;      // Pieces of the moving side that appeared (a promotion piece)
+    int captures = 0;       // Pieces of the other side that left the board
+    ChessBoardChange kingMove = {};
+    ChessBoardChange pieceMove = {};
+    ChessBoardChange pawnRemove = {};
+    ChessBoardChange pieceAdd = {};
+
+    for (const ChessBoardChange& change : computeBoardDiff(before.pieces, after.pieces)) {
+        const bool moverPiece = (std::isupper(static_cast<unsigned char>(change.piece)) != 0) == whiteMoved;
+        if (!moverPiece) {
+            if (change.type != ChessBoardChangeType::Remove) {
+                return std::string();  // The other side cannot move or gain pieces
+            }
+            ++captures;
+        }
+        else if (change.type == ChessBoardChangeType::Move) {
+            ++moverMoves;
+            (std::tolower(static_cast<unsigned char>(change.piece)) == 'k' ? kingMove : pieceMove) = change;
+        }
+        else if (change.type == ChessBoardChangeType::Remove) {
+            ++moverRemoves;
+            pawnRemove = change;
+        }
+        else {
+            ++moverAdds;
+            pieceAdd = change;
+        }
+    }
+
+    if (captures > 1) {
+        return std::string();
+    }
+
+    // Castling: the king and a rook moved, the king's move is the UCI move
+    if ((moverMoves == 2) && (moverRemoves == 0) && (moverAdds == 0) && (kingMove.piece != 0) && (pieceMove.piece != 0)
+        && (std::tolower(static_cast<unsigned char>(pieceMove.piece)) == 'r')) {
+        return boardIndexName(kingMove.fromIndex) + boardIndexName(kingMove.toIndex);
+    }
+
+    // Normal moves, captures and en passant: a single piece moved
+    if ((moverMoves == 1) && (moverRemoves == 0) && (moverAdds == 0)) {
+        const ChessBoardChange& move = (kingMove.piece != 0) ? kingMove : pieceMove;
+        return boardIndexName(move.fromIndex) + boardIndexName(move.toIndex);
+    }
+
+    // Promotion: a pawn disappeared and a new piece appeared
+    if ((moverMoves == 0) && (moverRemoves == 1) && (moverAdds == 1)
+        && (std::tolower(static_cast<unsigned char>(pawnRemove.piece)) == 'p')) {
+        return boardIndexName(pawnRemove.fromIndex) + boardIndexName(pieceAdd.toIndex)
+            + static_cast<char>(std::tolower(static_cast<unsigned char>(pieceAdd.piece)));
+    }
+
+    return std::string();  // More than one move, or no move at all
+}
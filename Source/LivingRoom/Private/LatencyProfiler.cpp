@@ -0,0 +1,163 @@
+#include "LatencyProfiler.h"  // Declares the LatencyProfiler class, which collects the durations of the AI request stages.
+#include <algorithm>          // Provides std::nth_element and std::max_element for percentiles.
+
+#if STATS
+DEFINE_STAT(STAT_ChessAI_Total);
+DEFINE_STAT(STAT_ChessAI_CacheLookup);
+DEFINE_STAT(STAT_ChessAI_EngineRequest);
+DEFINE_STAT(STAT_ChessAI_EngineStart);
+DEFINE_STAT(STAT_ChessAI_CommandWrite);
+DEFINE_STAT(STAT_ChessAI_Search);
+DEFINE_STAT(STAT_ChessAI_LegalMoves);
+DEFINE_STAT(STAT_ChessAI_OutputParsing);
+DEFINE_STAT(STAT_ChessAI_FENProcessing);
+#endif
+
+// Names of the stages, in the order of AILatencyStage
+static const char* const STAGE_NAMES[] = {
+    "Total", "CacheLookup", "EngineRequest", "EngineStart", "CommandWrite", "Search", "LegalMoves", "OutputParsing", "FENProcessing"
+};
+static_assert(sizeof(STAGE_NAMES) / sizeof(STAGE_NAMES[0]) == static_cast<size_t>(AILatencyStage::Count), "Every stage needs a name");
+
+// Retrieve the single instance of the LatencyProfiler class
+LatencyProfiler& LatencyProfiler::getInstance() {
+    static LatencyProfiler instance;
+    return instance;
+}
+
+const char* LatencyProfiler::stageName(AILatencyStage stage) {
+    return stage < AILatencyStage::Count ? STAGE_NAMES[static_cast<size_t>(stage)] : "Unknown";
+}
+
+bool LatencyProfiler::findStage(const std::string& name, AILatencyStage& stage) {
+    for (size_t index = 0; index < static_cast<size_t>(AILatencyStage::Count); ++index) {
+        if (name == STAGE_NAMES[index]) {
+            stage = static_cast<AILatencyStage>(index);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Records one duration, overwriting the oldest one once the stage has SAMPLES_PER_STAGE of them
+void LatencyProfiler::record(AILatencyStage stage, std::uint32_t microseconds) {
+    if (!enabled || stage >= AILatencyStage::Count) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    StageSamples& samples = stages[static_cast<size_t>(stage)];
+    if (samples.durations.size() < SAMPLES_PER_STAGE) {
+        samples.durations.push_back(microseconds);
+    }
+    else {
+        samples.durations[samples.next] = microseconds;
+        samples.next = (samples.next + 1) % SAMPLES_PER_STAGE;
+    }
+
+    if (traceFile.is_open()) {
+        const auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - traceStart);
+        traceFile << time.count() << ',' << stageName(stage) << ',' << microseconds << '\n';
+    }
+}
+
+// Returns a percentile of a copy of the durations, so recording never waits for the sort
+static std::uint32_t percentileOf(std::vector<std::uint32_t> durations, double percentile) {
+    if (durations.empty()) {
+        return 0;
+    }
+    const double clamped = std::min(100.0, std::max(0.0, percentile));
+    const size_t rank = static_cast<size_t>(clamped / 100.0 * static_cast<double>(durations.size() - 1) + 0.5);
+    std::nth_element(durations.begin(), durations.begin() + rank, durations.end());
+    return durations[rank];
+}
+
+std::uint32_t LatencyProfiler::getPercentile(AILatencyStage stage, double percentile) {
+    if (stage >= AILatencyStage::Count) {
+        return 0;
+    }
+    std::vector<std::uint32_t> durations;
+    {
+        std::lock_guard<std::mutex> lock(profilerMutex);
+        durations = stages[static_cast<size_t>(stage)].durations;
+    }
+    return percentileOf(std::move(durations), percentile);
+}
+
+size_t LatencyProfiler::getSampleCount(AILatencyStage stage) {
+    if (stage >= AILatencyStage::Count) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    return stages[static_cast<size_t>(stage)].durations.size();
+}
+
+void LatencyProfiler::reset() {
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    for (StageSamples& samples : stages) {
+        samples.durations.clear();
+        samples.next = 0;
+    }
+}
+
+void LatencyProfiler::setEnabled(bool enable) {
+    enabled = enable;
+}
+
+// Opens the CSV trace; time stamps start at zero
+bool LatencyProfiler::startTrace(const std::string& path) {
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    if (traceFile.is_open()) {
+        traceFile.close();
+    }
+    traceFile.open(path, std::ios::trunc);
+    if (!traceFile) {
+        return false;
+    }
+    traceFile << "time_us,stage,duration_us\n";
+    traceStart = std::chrono::steady_clock::now();
+    return true;
+}
+
+void LatencyProfiler::stopTrace() {
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    if (traceFile.is_open()) {
+        traceFile.close();
+    }
+}
+
+// Writes the statistics of every stage, e.g. {"stages":[{"stage":"Search","count":12,"mean_us":...}]}
+bool LatencyProfiler::writeSummary(const std::string& path) {
+    std::vector<std::uint32_t> durations[static_cast<size_t>(AILatencyStage::Count)];
+    {
+        std::lock_guard<std::mutex> lock(profilerMutex);
+        for (size_t index = 0; index < static_cast<size_t>(AILatencyStage::Count); ++index) {
+            durations[index] = stages[index].durations;
+        }
+    }
+
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    file << "{\"stages\":[";
+    for (size_t index = 0; index < static_cast<size_t>(AILatencyStage::Count); ++index) {
+        const std::vector<std::uint32_t>& stageDurations = durations[index];
+        std::uint64_t sum = 0;
+        for (std::uint32_t duration : stageDurations) {
+            sum += duration;
+        }
+        const std::uint64_t mean = stageDurations.empty() ? 0 : sum / stageDurations.size();
+        const std::uint32_t maximum = stageDurations.empty() ? 0 : *std::max_element(stageDurations.begin(), stageDurations.end());
+
+        file << (index ? "," : "") << "\n  {\"stage\":\"" << STAGE_NAMES[index] << "\",\"count\":" << stageDurations.size()
+            << ",\"mean_us\":" << mean
+            << ",\"p50_us\":" << percentileOf(stageDurations, 50.0)
+            << ",\"p95_us\":" << percentileOf(stageDurations, 95.0)
+            << ",\"p99_us\":" << percentileOf(stageDurations, 99.0)
+            << ",\"max_us\":" << maximum << "}";
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,239 @@
+#include "ResponseCache.h"  // Declares the ResponseCache class, the least-recently-used cache of engine responses.
+#include <cstring>          // Provides std::strchr for looking up piece characters.
+#include <fstream>          // Provides std::ifstream and std::ofstream for persisting the cache.
+
+// Identifies cache files written by saveToFile; the last character is the format version
+static const char CACHE_FILE_MAGIC[8] = { 'L', 'R', 'C', 'A', 'C', 'H', 'E', '3' };
+
+// Random keys for the Zobrist hash, generated once with a fixed seed so hashes are stable across runs
+// (cache files written by one session stay valid in the next)
+struct ZobristKeys {
+    std::uint64_t pieceSquare[12][64];  // One key per piece type and square
+    std::uint64_t castling[16];         // One key per combination of castling rights
+    std::uint64_t enPassant[64];        // One key per en passant square
+    std::uint64_t blackToMove;          // Toggled when black is to move
+
+    ZobristKeys() {
+        std::uint64_t seed = 1070372;
+        for (auto& squareKeys : pieceSquare) {
+            for (std::uint64_t& key : squareKeys) {
+                key = next(seed);
+            }
+        }
+        for (std::uint64_t& key : castling) {
+            key = next(seed);
+        }
+        for (std::uint64_t& key : enPassant) {
+            key = next(seed);
+        }
+        blackToMove = next(seed);
+    }
+
+    // SplitMix64 pseudo random number generator
+    static std::uint64_t next(std::uint64_t& state) {
+        std::uint64_t value = (state += 0x9E3779B97F4A7C15ULL);
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        return value ^ (value >> 31);
+    }
+};
+
+// Retrieve the single instance of the ResponseCache class
+ResponseCache& ResponseCache::getInstance() {
+    static ResponseCache instance;
+    return instance;
+}
+
+// Computes the Zobrist hash of a position
+std::uint64_t ResponseCache::hashPosition(const ChessPosition& position) {
+    static const ZobristKeys keys;
+    std::uint64_t hash = 0;
+
+    for (int index = 0; index < 64; ++index) {
+        if (!position.isEmpty(index)) {
+            const char* piece = std::strchr(CHESS_PIECE_CHARACTERS, position.pieces[index]);
+            hash ^= keys.pieceSquare[piece - CHESS_PIECE_CHARACTERS][index];
+        }
+    }
+
+    hash ^= keys.castling[position.castlingRights & 15];
+    if (position.enPassantSquare >= 0) {
+        hash ^= keys.enPassant[position.enPassantSquare];
+    }
+    if (!position.whitesTurn) {
+        hash ^= keys.blackToMove;
+    }
+
+    // Mix in the move clocks, since they are part of the corrected FEN and the draw offer flag
+    std::uint64_t clocks = (static_cast<std::uint64_t>(position.halfMoveClock) << 32) | static_cast<std::uint32_t>(position.fullMoveNumber);
+    return hash ^ ZobristKeys::next(clocks);
+}
+
+// Looks up a cached response and moves it to the front of the LRU list
+bool ResponseCache::find(std::uint64_t positionHash, int skillLevel, const SearchLimits& limits, StockfishResponse& response) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    auto entry = index.find({ positionHash, skillLevel, limits.moveTime, limits.nodes });
+    if (entry == index.end()) {
+        ++misses;
+        return false;
+    }
+
+    entries.splice(entries.begin(), entries, entry->second);  // Mark as most recently used
+    response = entry->second->second;
+    ++hits;
+    return true;
+}
+
+// Stores a response
+void ResponseCache::insert(std::uint64_t positionHash, int skillLevel, const SearchLimits& limits, const StockfishResponse& response) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    insertLocked({ positionHash, skillLevel, limits.moveTime, limits.nodes }, response);
+}
+
+// Stores a response and evicts the least recently used entries beyond the capacity
+void ResponseCache::insertLocked(const CacheKey& key, const StockfishResponse& response) {
+    auto entry = index.find(key);
+    if (entry != index.end()) {
+        entry->second->second = response;  // Replace the existing response
+        entries.splice(entries.begin(), entries, entry->second);
+        return;
+    }
+
+    entries.emplace_front(key, response);
+    index[key] = entries.begin();
+
+    while (entries.size() > capacity) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+}
+
+// Sets the maximum number of cached responses
+void ResponseCache::setCapacity(size_t maximumEntries) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    capacity = maximumEntries > 0 ? maximumEntries : 1;
+
+    while (entries.size() > capacity) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+}
+
+// Removes all entries and resets the counters
+void ResponseCache::clear() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    entries.clear();
+    index.clear();
+    hits = 0;
+    misses = 0;
+}
+
+std::uint64_t ResponseCache::getHits() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return hits;
+}
+
+std::uint64_t ResponseCache::getMisses() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return misses;
+}
+
+size_t ResponseCache::getSize() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return entries.size();
+}
+
+// Helpers for the binary cache file: plain values are written as raw bytes, strings with their length first
+template <typename T>
+static void writeValue(std::ofstream& file, const T& value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void writeString(std::ofstream& file, const std::string& text) {
+    writeValue(file, static_cast<std::uint32_t>(text.size()));
+    file.write(text.data(), text.size());
+}
+
+template <typename T>
+static bool readValue(std::ifstream& file, T& value) {
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+static bool readString(std::ifstream& file, std::string& text) {
+    std::uint32_t length = 0;
+    if (!readValue(file, length) || length > (1u << 20)) {
+        return false;  // Missing or implausibly long string, the file is damaged
+    }
+    text.resize(length);
+    return length == 0 || static_cast<bool>(file.read(&text[0], length));
+}
+
+// Writes all entries to a binary file, least recently used first, so loading restores the LRU order
+bool ResponseCache::saveToFile(const std::string& path) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    file.write(CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC));
+    writeValue(file, static_cast<std::uint64_t>(entries.size()));
+
+    for (auto entry = entries.rbegin(); entry != entries.rend(); ++entry) {
+        const StockfishResponse& response = entry->second;
+        writeValue(file, entry->first.positionHash);
+        writeValue(file, static_cast<std::int32_t>(entry->first.skillLevel));
+        writeValue(file, static_cast<std::int32_t>(entry->first.moveTime));
+        writeValue(file, entry->first.nodes);
+        writeString(file, response.fen);
+        writeValue(file, response.bestMove.data);
+        writeValue(file, response.legalMoveCount);
+        file.write(reinterpret_cast<const char*>(response.legalMoves), response.legalMoveCount * sizeof(ChessMove));
+        file.write(response.board, sizeof(response.board));
+        writeValue(file, response.flags);
+    }
+
+    return static_cast<bool>(file);
+}
+
+// Adds the entries of a cache file
+bool ResponseCache::loadFromFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(CACHE_FILE_MAGIC)];
+    std::uint64_t count = 0;
+
+    if (!file || !file.read(magic, sizeof(magic)) || std::memcmp(magic, CACHE_FILE_MAGIC, sizeof(magic)) != 0
+        || !readValue(file, count)) {
+        return false;  // Missing file, other format or older version
+    }
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    for (std::uint64_t entry = 0; entry < count; ++entry) {
+        CacheKey key;
+        std::int32_t skillLevel = 0;
+        std::int32_t moveTime = 0;
+        StockfishResponse response;
+        std::uint16_t moveCount = 0;
+        ChessMove moves[MAX_LEGAL_MOVES];
+
+        if (!readValue(file, key.positionHash) || !readValue(file, skillLevel) || !readValue(file, moveTime) || !readValue(file, key.nodes)
+            || !readString(file, response.fen) || !readValue(file, response.bestMove.data)
+            || !readValue(file, moveCount) || moveCount > MAX_LEGAL_MOVES
+            || !file.read(reinterpret_cast<char*>(moves), moveCount * sizeof(ChessMove))
+            || !file.read(response.board, sizeof(response.board)) || !readValue(file, response.flags)) {
+            return false;  // Truncated or damaged file; the entries read so far are kept
+        }
+
+        // The move targets are not stored; they are rebuilt from the moves
+        for (std::uint16_t move = 0; move < moveCount; ++move) {
+            response.addLegalMove(moves[move]);
+        }
+        key.skillLevel = skillLevel;
+        key.moveTime = moveTime;
+        insertLocked(key, response);
+    }
+
+    return true;
+}
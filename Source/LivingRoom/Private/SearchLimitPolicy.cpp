@@ -0,0 +1,37 @@
+#include "SearchLimitPolicy.h"  // Declares the SearchLimitPolicy class, which turns skill levels into search limits.
+#include <algorithm>            // Provides std::clamp and std::max for keeping values in range.
+
+// Nodes searched at skill level 0; every two skill levels double it (about 20 million nodes at level 20)
+const std::uint64_t BASE_NODES = 20000;
+
+// Returns the limits as arguments of the "go" command
+std::string SearchLimits::toGoArguments() const {
+    std::string arguments = "movetime " + std::to_string(moveTime);
+    if (nodes > 0) {
+        arguments += " nodes " + std::to_string(nodes);
+    }
+    return arguments;
+}
+
+// Turns a skill level into search limits within the budget
+SearchLimits SearchLimitPolicy::limitsFor(const int& skillLevel) const {
+    const int skill = std::clamp(skillLevel, 0, 20);
+    SearchLimits limits;
+
+    // Weak levels use a fifth of the budget, the strongest level all of it
+    limits.moveTime = std::max(1, timeBudget * (20 + 4 * skill) / 100);
+
+    // The node limit decides the strength whenever the machine is fast enough to reach it in time
+    limits.nodes = BASE_NODES << (skill / 2);
+    return limits;
+}
+
+// Sets the wall-clock budget of a search
+void SearchLimitPolicy::setTimeBudget(const int& milliseconds) {
+    timeBudget = std::max(10, milliseconds);
+}
+
+// Returns the wall-clock budget of a search
+int SearchLimitPolicy::getTimeBudget() const {
+    return timeBudget;
+}
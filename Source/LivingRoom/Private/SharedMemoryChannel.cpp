@@ -0,0 +1,236 @@
+#include "SharedMemoryChannel.h"  // Declares the SharedMemoryChannel class, the shared memory transport to the Stockfish process.
+#include <chrono>                 // Provides steady_clock and microseconds for waiting and sleeping.
+#include <iostream>               // Provides std::cerr for logging errors.
+#include <thread>                 // Provides std::this_thread::yield and sleep_for for the backoff.
+
+#ifndef _WIN32
+#include <fcntl.h>                // Provides O_CREAT and O_RDWR for shm_open.
+#include <sys/mman.h>             // Provides shm_open, shm_unlink, mmap and munmap.
+#include <unistd.h>               // Provides ftruncate, close and getpid.
+#endif
+#ifdef __linux__
+#include <linux/futex.h>          // Provides FUTEX_WAKE for waking the idle engine.
+#include <sys/syscall.h>          // Provides SYS_futex.
+#endif
+
+// Append a record; the line is truncated to what fits into an empty ring
+template<size_t Capacity>
+bool SharedMemoryChannel::Ring<Capacity>::tryPush(const char* line, size_t size) {
+    const std::uint32_t length = static_cast<std::uint32_t>(std::min(size, Capacity - sizeof(std::uint32_t)));
+    const std::uint64_t writePosition = head.load(std::memory_order_relaxed);
+    const std::uint64_t readPosition = tail.load(std::memory_order_acquire);
+
+    if (Capacity - (writePosition - readPosition) < sizeof(length) + length) {
+        return false;  // The engine has not caught up yet
+    }
+    copyIn(writePosition, &length, sizeof(length));
+    copyIn(writePosition + sizeof(length), line, length);
+    head.store(writePosition + sizeof(length) + length, std::memory_order_release);  // Publishes the record
+    return true;
+}
+
+// Take the oldest record
+template<size_t Capacity>
+bool SharedMemoryChannel::Ring<Capacity>::tryPop(std::string& line) {
+    const std::uint64_t readPosition = tail.load(std::memory_order_relaxed);
+    const std::uint64_t writePosition = head.load(std::memory_order_acquire);
+
+    if (readPosition == writePosition) {
+        return false;
+    }
+    std::uint32_t length = 0;
+    copyOut(readPosition, &length, sizeof(length));
+    line.resize(length);
+    copyOut(readPosition + sizeof(length), &line[0], length);
+    tail.store(readPosition + sizeof(length) + length, std::memory_order_release);  // Frees the space for the engine
+    return true;
+}
+
+template<size_t Capacity>
+void SharedMemoryChannel::Ring<Capacity>::copyIn(std::uint64_t position, const void* source, size_t size) {
+    const size_t offset = static_cast<size_t>(position & (Capacity - 1));
+    const size_t first = std::min(size, Capacity - offset);
+    std::memcpy(data + offset, source, first);
+    std::memcpy(data, static_cast<const char*>(source) + first, size - first);
+}
+
+template<size_t Capacity>
+void SharedMemoryChannel::Ring<Capacity>::copyOut(std::uint64_t position, void* destination, size_t size) const {
+    const size_t offset = static_cast<size_t>(position & (Capacity - 1));
+    const size_t first = std::min(size, Capacity - offset);
+    std::memcpy(destination, data + offset, first);
+    std::memcpy(static_cast<char*>(destination) + first, data, size - first);
+}
+
+SharedMemoryChannel::~SharedMemoryChannel() {
+    close();
+}
+
+// Create and map a segment named after the game's process and the pool slot
+bool SharedMemoryChannel::create(int instanceIndex) {
+    close();
+
+#ifdef _WIN32
+    const std::uint64_t process = GetCurrentProcessId();
+    name = "Local\\LivingRoom-Stockfish-" + std::to_string(process) + "-" + std::to_string(instanceIndex);
+    mappingHandle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, static_cast<DWORD>(sizeof(Segment)), name.c_str());
+    if (!mappingHandle) {
+        std::cerr << "CreateFileMapping failed (" << GetLastError() << ").\n";
+        name.clear();
+        return false;
+    }
+    void* mapping = MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(Segment));
+    if (!mapping) {
+        std::cerr << "MapViewOfFile failed (" << GetLastError() << ").\n";
+        CloseHandle(mappingHandle);
+        mappingHandle = NULL;
+        name.clear();
+        return false;
+    }
+    signalEvent = CreateEventA(NULL, FALSE, FALSE, (name + "-signal").c_str());  // Without it the engine polls
+#else
+    const std::uint64_t process = static_cast<std::uint64_t>(getpid());
+    name = "/livingroom-sf-" + std::to_string(process) + "-" + std::to_string(instanceIndex);  // macOS allows 31 characters
+    shm_unlink(name.c_str());  // Left over from a crashed run with the same process id
+    int descriptor = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (descriptor == -1) {
+        std::cerr << "Failed to create shared memory segment " << name << ".\n";
+        name.clear();
+        return false;
+    }
+    void* mapping = MAP_FAILED;
+    if (ftruncate(descriptor, sizeof(Segment)) == 0) {  // New pages are zero-filled: empty rings
+        mapping = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    }
+    ::close(descriptor);  // The mapping keeps the segment alive
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Failed to map shared memory segment " << name << ".\n";
+        shm_unlink(name.c_str());
+        name.clear();
+        return false;
+    }
+#endif
+
+    std::lock_guard<std::mutex> lock(writeMutex);
+    segment = static_cast<Segment*>(mapping);
+    segment->magic = MAGIC;
+    segment->version = VERSION;
+    segment->hostProcess = process;
+    return true;
+}
+
+bool SharedMemoryChannel::isOpen() const {
+    return segment != nullptr;
+}
+
+std::string SharedMemoryChannel::environmentEntry() const {
+    return "STOCKFISH_SHM=" + name;
+}
+
+bool SharedMemoryChannel::engineAttached() const {
+    return segment && segment->attached.load(std::memory_order_acquire) != 0;
+}
+
+// Use the segment from now on; nobody else needs to find it by name
+void SharedMemoryChannel::activate() {
+#ifndef _WIN32
+    if (!name.empty()) {
+        shm_unlink(name.c_str());
+        name.clear();
+    }
+#endif
+    active = true;
+}
+
+bool SharedMemoryChannel::isActive() const {
+    return active;
+}
+
+// Write one record per line; a full ring means the engine is busy, so wait for it within the timeout
+bool SharedMemoryChannel::writeLines(const std::string& text, const int& timeout) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (!segment) {
+        return false;
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+    size_t lineStart = 0;
+    while (lineStart < text.size()) {
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string::npos) {
+            lineEnd = text.size();
+        }
+
+        int rounds = 0;
+        while (!segment->commands.tryPush(text.data() + lineStart, lineEnd - lineStart)) {
+            if (backoff(rounds) && std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+        }
+        lineStart = lineEnd + 1;
+    }
+    signalEngine();
+    return true;
+}
+
+// Bump the signal word after the records are published; only an engine that announced its wait needs a system call
+void SharedMemoryChannel::signalEngine() {
+    segment->commandSignal.fetch_add(1);
+    if (!segment->engineWaiting.load()) {
+        return;  // Still polling, it will see the records without help
+    }
+#ifdef _WIN32
+    if (signalEvent) {
+        SetEvent(signalEvent);
+    }
+#elif defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&segment->commandSignal), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#endif
+}
+
+bool SharedMemoryChannel::readLine(std::string& line) {
+    return segment && segment->output.tryPop(line);
+}
+
+// Unmap the segment; a Stockfish process still attached keeps its own mapping until it is killed
+void SharedMemoryChannel::close() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    active = false;
+    if (!segment) {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(segment);
+    CloseHandle(mappingHandle);
+    mappingHandle = NULL;
+    if (signalEvent) {
+        CloseHandle(signalEvent);
+        signalEvent = NULL;
+    }
+#else
+    munmap(segment, sizeof(Segment));
+    if (!name.empty()) {
+        shm_unlink(name.c_str());
+    }
+#endif
+    segment = nullptr;
+    name.clear();
+}
+
+// Spin, then yield, then sleep for longer and longer. On a single core, spinning only delays the engine
+bool SharedMemoryChannel::backoff(int& rounds) {
+    static const bool spin = std::thread::hardware_concurrency() > 1;
+    if (rounds < 10000) {
+        ++rounds;  // Saturates in the longest sleep
+    }
+    if (rounds < 200 && spin) {
+        return false;
+    }
+    if (rounds < 2000) {
+        std::this_thread::yield();
+        return false;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(rounds < 10000 ? 50 : 500));
+    return true;
+}
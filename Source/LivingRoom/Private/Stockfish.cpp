@@ -1,18 +1,24 @@
 #include "Stockfish.h"      // Declares the Stockfish class, which handles communication with the Stockfish engine, processes commands, and manages input/output handling.
-#include <chrono>           // Provides tools for handling time-related functionality.
+#include "FENParser.h"      // Provides FENParser::isSamePosition for matching requests against the pondered position.
+#include "LatencyProfiler.h" // Provides the SCOPE_AI_LATENCY timers for the engine start, the command writes and the search.
+#include <chrono>           // Provides steady_clock for the response timeout.
 #include <iostream>         // Provides input and output functionalities (e.g., std::cout and std::cerr for logging and debugging).
 #include <sstream>          // Provides std::stringstream for parsing and processing strings.
 #include <stdio.h>          // Provides standard I/O functions (required for POSIX systems).
 #include <string>           // Provides std::string for handling text.
-#include <thread>           // Provides multithreading support for adding delays or sleeps.
 #include <vector>           // Provides std::vector for storing dynamic arrays.
 
 #ifdef _WIN32
 #include <windows.h>        // Windows API functions for process and pipe handling.
 #else
 #include <unistd.h>         // POSIX functions for pipe and process handling on macOS/Linux.
+#include <csignal>          // Provides kill and SIGKILL for stopping a stuck Stockfish process, and SIGPIPE.
+#include <poll.h>           // POSIX poll() for waiting until Stockfish has written output.
+#include <cerrno>           // Provides errno for telling interrupted system calls from real errors.
 #include <sys/wait.h>       // POSIX functions for waiting on child processes.
 #include <fcntl.h>          // For file control options like O_NONBLOCK.
+
+extern char** environ;      // Environment of the game, passed on to Stockfish with the shared memory segment's name.
 #endif
 
 // Path to Stockfish executable
@@ -38,40 +44,144 @@ std::wstring Stockfish::convertToWideString(const std::string& str) {
 }
 #endif
 
-// Singleton instance method to get the unique Stockfish object
-Stockfish& Stockfish::getInstance() {
-    static Stockfish instance;
-    return instance;
+Stockfish::Stockfish(int instanceIndex) : instanceIndex(instanceIndex) {}
+
+Stockfish::~Stockfish() {
+    closeStockfish();
+#ifndef _WIN32
+    pthread_mutex_destroy(&stockfishMutex); // Clean up mutex
+#endif
+}
+
+// Returns true if the last of the lines starts with the given prefix (e.g. the "bestmove" line of a complete answer)
+static bool endsWithLine(const std::vector<std::string>& lines, const std::string& prefix) {
+    return !lines.empty() && lines.back().compare(0, prefix.size(), prefix) == 0;
 }
 
 // Check if the Stockfish process is already running using a mutex
 bool Stockfish::isStockfishAlreadyRunning() {
 #ifdef _WIN32
-    stockfishMutex = CreateMutexW(NULL, TRUE, L"StockfishMutex");
+    if (stockfishMutex) {
+        return false;  // This instance already holds the mutex
+    }
+    stockfishMutex = CreateMutexW(NULL, TRUE, (L"StockfishMutex-" + std::to_wstring(instanceIndex)).c_str());  // One per pool slot
     if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        CloseHandle(stockfishMutex);
+        stockfishMutex = NULL;
         return true;  // Mutex already exists, meaning Stockfish is running
     }
     return false;
 #else
-    lockFileDescriptor = open("/tmp/stockfish.lock", O_CREAT | O_RDWR, 0666);  // Create lock file
+    if (lockFileDescriptor != -1) {
+        return false;  // This instance already holds the lock, e.g. while the watchdog restarts the engine
+    }
+    const std::string lockFile = "/tmp/stockfish-" + std::to_string(instanceIndex) + ".lock";  // One per pool slot
+    lockFileDescriptor = open(lockFile.c_str(), O_CREAT | O_RDWR, 0666);  // Create lock file
     if (lockFileDescriptor == -1) {
         std::cerr << "Failed to create lock file\n";
         return true;  // Unable to open lock file, assuming Stockfish is running
     }
     if (flock(lockFileDescriptor, LOCK_EX | LOCK_NB) == -1) {
         close(lockFileDescriptor);
+        lockFileDescriptor = -1;
         return true;  // Could not obtain file lock, Stockfish is likely running
     }
     return false;  // Successfully obtained lock
 #endif
 }
 
+// Release the single-instance lock, so a restarted engine (or another game instance) can take it
+void Stockfish::releaseInstanceLock() {
+#ifdef _WIN32
+    if (stockfishMutex) {
+        ReleaseMutex(stockfishMutex);
+        CloseHandle(stockfishMutex);
+        stockfishMutex = NULL;
+    }
+#else
+    if (lockFileDescriptor != -1) {
+        flock(lockFileDescriptor, LOCK_UN);  // Unlock the file
+        close(lockFileDescriptor);            // Close the file descriptor
+        lockFileDescriptor = -1;
+    }
+#endif
+}
+
+// Check whether the Stockfish process is still running
+bool Stockfish::isStockfishAlive() {
+#ifdef _WIN32
+    return pi.hProcess && WaitForSingleObject(pi.hProcess, 0) == WAIT_TIMEOUT;
+#else
+    if (stockfishPid <= 0) {
+        return false;
+    }
+    int status = 0;
+    if (waitpid(stockfishPid, &status, WNOHANG) == stockfishPid) {
+        stockfishPid = -1;  // Exited and reaped
+        return false;
+    }
+    return true;
+#endif
+}
+
+// Kill the Stockfish process and close everything that belongs to it
+void Stockfish::terminateStockfish() {
+    // stopStockfish and stopRequest write "stop" from the game thread under searchMutex, so the handles and the channel
+    // are closed under it too; "stop" then finds no search and no input handle instead of a closed or reused one
+    std::lock_guard<std::mutex> searchLock(searchMutex);
+    searchRequest = nullptr;
+#ifdef _WIN32
+    if (pi.hProcess) {
+        TerminateProcess(pi.hProcess, 1);
+        WaitForSingleObject(pi.hProcess, 1000);
+        CloseHandle(pi.hProcess);
+        CloseHandle(pi.hThread);
+    }
+    ZeroMemory(&pi, sizeof(pi));
+    for (HANDLE* handle : { &hStdinRead, &hStdinWrite, &hStdoutRead, &hStdoutWrite, &hStderrRead, &hStderrWrite }) {
+        if (*handle) {
+            CloseHandle(*handle);
+            *handle = NULL;
+        }
+    }
+#else
+    if (stockfishPid > 0) {
+        kill(stockfishPid, SIGKILL);
+        waitpid(stockfishPid, nullptr, 0);  // Reap the child, so no zombie process is left behind
+        stockfishPid = -1;
+    }
+    for (int* descriptor : { &hStdinWrite, &hStdoutRead, &hStderrRead }) {
+        if (*descriptor) {
+            close(*descriptor);
+            *descriptor = 0;
+        }
+    }
+#endif
+    channel.close();  // Unmaps the shared memory segment, if the transport was used
+    releaseInstanceLock();
+    outputBuffer.clear();
+    missedTerminator.clear();
+    pondering = false;
+    currentSkillLevel = -1;
+}
+
 // Start the Stockfish engine and configure its settings
 void Stockfish::startStockfish(const int& skillLevel) {
+    // Already running: only a changed skill level has to be sent, the handshake happened at start-up
+    if (hStdinWrite) {
+        if (skillLevel != currentSkillLevel) {
+            sendStockfishCommand("setoption name Skill Level value " + std::to_string(skillLevel));
+            currentSkillLevel = skillLevel;
+        }
+        return;
+    }
+
     if (isStockfishAlreadyRunning()) {
         return;
     }
 
+    SCOPE_AI_LATENCY(EngineStart);  // Process launch and UCI handshake
+
 #ifdef _WIN32
     // Windows-specific code for creating pipes and launching Stockfish
     saAttr.nLength = sizeof(SECURITY_ATTRIBUTES);
@@ -82,12 +192,15 @@ void Stockfish::startStockfish(const int& skillLevel) {
     si.cb = sizeof(si);
     ZeroMemory(&pi, sizeof(pi));
 
-    // Create pipes for communication with Stockfish
-    if (!CreatePipe(&hStdinRead, &hStdinWrite, &saAttr, 0) ||
-        !CreatePipe(&hStdoutRead, &hStdoutWrite, &saAttr, 0) ||
-        !CreatePipe(&hStderrRead, &hStderrWrite, &saAttr, 0)) {
-        std::cerr << "CreatePipe failed (" << GetLastError() << ").\n";
-        return;
+    // Create pipes for communication with Stockfish; stopStockfish reads the input handle under searchMutex
+    {
+        std::lock_guard<std::mutex> searchLock(searchMutex);
+        if (!CreatePipe(&hStdinRead, &hStdinWrite, &saAttr, 0) ||
+            !CreatePipe(&hStdoutRead, &hStdoutWrite, &saAttr, 0) ||
+            !CreatePipe(&hStderrRead, &hStderrWrite, &saAttr, 0)) {
+            std::cerr << "CreatePipe failed (" << GetLastError() << ").\n";
+            return;
+        }
     }
 
     si.hStdError = hStderrWrite;
@@ -97,12 +210,34 @@ void Stockfish::startStockfish(const int& skillLevel) {
 
     std::wstring widePath = convertToWideString(path);
 
+    // With the shared memory transport, the process finds the segment's name in its environment
+    std::wstring environmentBlock;
+    if (sharedMemoryEnabled && channel.create(instanceIndex)) {
+        LPWCH variables = GetEnvironmentStringsW();
+        for (LPWCH variable = variables; variable && *variable; variable += wcslen(variable) + 1) {
+            environmentBlock.append(variable);
+            environmentBlock.push_back(L'\0');
+        }
+        FreeEnvironmentStringsW(variables);
+        environmentBlock += convertToWideString(channel.environmentEntry());  // Includes its terminating null
+        environmentBlock.push_back(L'\0');  // End of the block
+    }
+    const DWORD creationFlags = CREATE_NO_WINDOW | (environmentBlock.empty() ? 0 : CREATE_UNICODE_ENVIRONMENT);
+
     // Start the Stockfish process
-    if (!CreateProcess(widePath.c_str(), NULL, NULL, NULL, TRUE, CREATE_NO_WINDOW, NULL, NULL, &si, &pi)) {
+    if (!CreateProcess(widePath.c_str(), NULL, NULL, NULL, TRUE, creationFlags, environmentBlock.empty() ? NULL : &environmentBlock[0], NULL, &si, &pi)) {
         std::cerr << "CreateProcess failed (" << GetLastError() << ").\n";
         return;
     }
 
+    // The child owns its ends of the pipes now; closing ours lets a read fail as soon as the process exits
+    CloseHandle(hStdinRead);
+    CloseHandle(hStdoutWrite);
+    CloseHandle(hStderrWrite);
+    hStdinRead = NULL;
+    hStdoutWrite = NULL;
+    hStderrWrite = NULL;
+
 #else
     // macOS/Linux-specific code for creating pipes and launching Stockfish
     if (pipe(this->stdinPipe) == -1 || pipe(this->stdoutPipe) == -1 || pipe(this->stderrPipe) == -1) {
@@ -110,6 +245,19 @@ void Stockfish::startStockfish(const int& skillLevel) {
         return;
     }
 
+    // With the shared memory transport, the process finds the segment's name in its environment.
+    // The environment is prepared before fork, because the child may only make async-signal-safe calls.
+    std::string environmentEntry;
+    std::vector<char*> environment;
+    if (sharedMemoryEnabled && channel.create(instanceIndex)) {
+        environmentEntry = channel.environmentEntry();
+        for (char** variable = environ; *variable; ++variable) {
+            environment.push_back(*variable);
+        }
+        environment.push_back(&environmentEntry[0]);
+        environment.push_back(nullptr);
+    }
+
     pid_t pid = fork();  // Create a new process
     if (pid == -1) {
         std::cerr << "Fork failed.\n";
@@ -126,6 +274,10 @@ void Stockfish::startStockfish(const int& skillLevel) {
         close(stdoutPipe[0]);
         close(stderrPipe[0]);
 
+        if (!environment.empty()) {
+            char* const arguments[] = { const_cast<char*>("stockfish"), nullptr };
+            execve(path, arguments, environment.data());  // Launch Stockfish with the segment's name
+        }
         execl(path, "stockfish", NULL);  // Launch Stockfish
         _exit(EXIT_FAILURE);  // Should never reach here if exec is successful
     }
@@ -135,20 +287,127 @@ void Stockfish::startStockfish(const int& skillLevel) {
         close(stdoutPipe[1]);
         close(stderrPipe[1]);
 
-        hStdinWrite = stdinPipe[1];
+        {
+            std::lock_guard<std::mutex> searchLock(searchMutex);  // stopStockfish reads the input handle from the game thread
+            hStdinWrite = stdinPipe[1];
+        }
         hStdoutRead = stdoutPipe[0];
         hStderrRead = stderrPipe[0];
+        stockfishPid = pid;
+
+        // A write to an engine that just died must fail with EPIPE instead of terminating the game
+        signal(SIGPIPE, SIG_IGN);
     }
 #endif
+    outputBuffer.clear();  // Drop partial output of a previous Stockfish process
+    missedTerminator.clear();
+    connectChannel();      // Switch to shared memory if the process attached to the segment
+
+    // UCI handshake, once per engine lifetime: the engine lists its options and confirms with "uciok"
+    sendStockfishCommand("uci");
+    bool handshakeComplete = endsWithLine(readStockfishOutput("uciok", responseTimeout), "uciok");
+
+    // Configure Stockfish options and wait until they are applied
+    if (handshakeComplete) {
+        sendStockfishCommand("setoption name Threads value 2\n"
+            "setoption name Ponder value true\n"
+            "setoption name Skill Level value " + std::to_string(skillLevel) + "\n"
+            "isready");
+        handshakeComplete = endsWithLine(readStockfishOutput("readyok", responseTimeout), "readyok");
+    }
+
+    if (!handshakeComplete) {
+        std::cerr << "Stockfish did not complete the UCI handshake.\n";
+        terminateStockfish();  // E.g. the executable is missing; the next request tries again
+        return;
+    }
+    currentSkillLevel = skillLevel;
+}
+
+// Wait until the new process has mapped the shared memory segment, or has shown that it does not know about it
+void Stockfish::connectChannel() {
+    if (!channel.isOpen()) {
+        return;  // Pipes only
+    }
+
+    // Stockfish attaches before it prints its banner, so a banner on the pipe means the executable lacks the transport
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(responseTimeout);
+    while (!channel.engineAttached() && std::chrono::steady_clock::now() < deadline) {
+#ifdef _WIN32
+        DWORD bytesAvailable = 0;
+        if (!PeekNamedPipe(hStdoutRead, NULL, 0, NULL, &bytesAvailable, NULL) || bytesAvailable > 0) {
+            break;  // Output on the pipe, or the process is gone
+        }
+        Sleep(1);
+#else
+        pollfd stdoutPoll = { hStdoutRead, POLLIN, 0 };
+        if (poll(&stdoutPoll, 1, 1) > 0) {
+            break;  // Output on the pipe, or the process closed it
+        }
+#endif
+    }
+
+    if (channel.engineAttached()) {
+        channel.activate();
+        return;
+    }
+    std::cerr << "Stockfish did not attach to the shared memory segment, using pipes.\n";
+    channel.close();
+}
+
+// Start the engine before the first request and let it run one tiny search
+void Stockfish::prewarmStockfish(const int& skillLevel) {
+    std::lock_guard<std::mutex> lock(requestMutex);  // A request arriving meanwhile waits for the warm engine
+
+    if (StockfishEngine::isAvailable()) {
+        inProcessEngine.prewarm(skillLevel);
+        return;
+    }
+
+    if (pondering) {
+        return;  // A ponder search only runs on an engine that is already warm
+    }
+
+    startStockfish(skillLevel);  // Launch, "uciok", options and "readyok"
+    if (!hStdinWrite) {
+        return;  // Stockfish could not be started
+    }
 
-    // Configure Stockfish options
-    sendStockfishCommand("setoption name Threads value 2\n");
-    sendStockfishCommand("setoption name Skill Level value " + std::to_string(skillLevel) + "\n");
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));  // Small delay to let Stockfish initialize
+    // The first search loads the network and touches the hash table; depth 1 keeps it to a few milliseconds
+    getStockfishResults("position startpos\ngo depth 1");
+}
+
+// Set the wall-clock budget of a search; the answer must still arrive within the response timeout
+void Stockfish::setSearchTimeBudget(const int& milliseconds) {
+    std::lock_guard<std::mutex> lock(requestMutex);  // A running request reads responseTimeout
+    limitPolicy.setTimeBudget(milliseconds);
+    if (responseTimeout < limitPolicy.getTimeBudget() + 2000) {
+        responseTimeout = limitPolicy.getTimeBudget() + 2000;  // Leave room for starting the search and the legal moves
+    }
+}
+
+// Set how long a request waits for the engine's answer before the watchdog steps in
+void Stockfish::setResponseTimeout(const int& milliseconds) {
+    std::lock_guard<std::mutex> lock(requestMutex);
+    responseTimeout = milliseconds;
+}
+
+// Set how long a live engine may take to answer the watchdog's heartbeat
+void Stockfish::setHeartbeatTimeout(const int& milliseconds) {
+    std::lock_guard<std::mutex> lock(requestMutex);
+    heartbeatTimeout = milliseconds;
 }
 
 // Send a command to Stockfish
 void Stockfish::sendStockfishCommand(const std::string& str) {
+    SCOPE_AI_LATENCY(CommandWrite);
+    if (channel.isActive()) {
+        // One record per line in the shared command ring
+        if (!channel.writeLines(str, responseTimeout)) {
+            std::cerr << "Failed to send command: " << str << "\n";
+        }
+        return;
+    }
     std::string commandWithNewline = str + "\n";  // Add newline to command
 #ifdef _WIN32
     DWORD bytesWritten;
@@ -160,89 +419,407 @@ void Stockfish::sendStockfishCommand(const std::string& str) {
         std::cerr << "Failed to send command: " << str << "\n";
     }
 #endif
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));  // Wait for Stockfish to process the command
 }
 
-// Read Stockfish output and return it as a vector of strings
-std::vector<std::string> Stockfish::readStockfishOutput() {
+// Read Stockfish output until a line starting with the terminator arrives. The late answer to a command that
+// timed out is skipped first, so it can never be taken for the answer to the next command.
+std::vector<std::string> Stockfish::readStockfishOutput(const std::string& terminator, const int& timeout) {
     std::vector<std::string> lines;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+
+    if (!hStdoutRead) {
+        return lines;  // Stockfish was never started
+    }
+
+    // Waiting for the missed terminator again (e.g. after "stop") simply continues the read that timed out
+    if (!missedTerminator.empty() && missedTerminator != terminator) {
+        if (!readStockfishLines(missedTerminator, deadline, lines)) {
+            return std::vector<std::string>();  // Still no answer to the earlier command; nothing of this one yet
+        }
+        lines.clear();
+    }
+
+    missedTerminator.clear();
+    if (!readStockfishLines(terminator, deadline, lines)) {
+        missedTerminator = terminator;  // Its answer may still arrive and has to be skipped by the next read
+    }
+    return lines;
+}
+
+// Read Stockfish output line by line until a line starting with the terminator arrives.
+// Bytes after the last newline stay in outputBuffer, so a line split across two reads is never cut in half.
+bool Stockfish::readStockfishLines(const std::string& terminator, const std::chrono::steady_clock::time_point& deadline, std::vector<std::string>& lines) {
     char buffer[4096];
-#ifdef _WIN32
-    DWORD bytesRead;
-    BOOL success;
+
+    if (channel.isActive()) {
+        // Every record in the output ring is one complete line, so there is nothing to buffer or split
+        std::string line;
+        int idleRounds = 0;
+        while (true) {
+            while (channel.readLine(line)) {
+                idleRounds = 0;
+                bool isTerminator = line.compare(0, terminator.size(), terminator) == 0;
+                lines.push_back(line);
+                if (isTerminator) {
+                    return true;
+                }
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                std::cerr << "Timed out waiting for Stockfish to send: " << terminator << "\n";
+                return false;
+            }
+            // Spin while the engine is busy; once the wait gets long, check now and then that the process still runs
+            if (SharedMemoryChannel::backoff(idleRounds) && !isStockfishAlive()) {
+                return false;
+            }
+        }
+    }
+
     while (true) {
-        success = ReadFile(hStdoutRead, buffer, sizeof(buffer) - 1, &bytesRead, NULL);
-        if (!success || bytesRead == 0) {
-            if (GetLastError() == ERROR_BROKEN_PIPE) break;
+        // Hand out every complete line received so far and stop as soon as the terminating line arrives
+        size_t lineEnd;
+        while ((lineEnd = outputBuffer.find('\n')) != std::string::npos) {
+            std::string line = outputBuffer.substr(0, lineEnd);
+            outputBuffer.erase(0, lineEnd + 1);
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();  // Windows builds of Stockfish end their lines with \r\n
+            }
+            bool isTerminator = line.compare(0, terminator.size(), terminator) == 0;
+            lines.push_back(line);
+            if (isTerminator) {
+                return true;
+            }
+        }
+
+        // Wait for more output, but never longer than the configured timeout
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) {
+            std::cerr << "Timed out waiting for Stockfish to send: " << terminator << "\n";
+            return false;
+        }
+#ifdef _WIN32
+        // Anonymous pipes cannot be waited on, so check for pending bytes before the (blocking) read
+        DWORD bytesAvailable = 0;
+        if (!PeekNamedPipe(hStdoutRead, NULL, 0, NULL, &bytesAvailable, NULL)) {
+            std::cerr << "Error reading from pipe: " << GetLastError() << "\n";
+            return false;
+        }
+        if (bytesAvailable == 0) {
+            Sleep(1);
+            continue;
+        }
+        DWORD bytesRead = 0;
+        DWORD bytesToRead = bytesAvailable < sizeof(buffer) ? bytesAvailable : static_cast<DWORD>(sizeof(buffer));
+        if (!ReadFile(hStdoutRead, buffer, bytesToRead, &bytesRead, NULL) || bytesRead == 0) {
             std::cerr << "Error reading from pipe: " << GetLastError() << "\n";
-            break;
+            return false;
         }
-        buffer[bytesRead] = '\0';  // Null-terminate the buffer
 #else
-    ssize_t bytesRead;
-    while ((bytesRead = read(hStdoutRead, buffer, sizeof(buffer) - 1)) > 0) {
-        buffer[bytesRead] = '\0';  // Null-terminate the buffer
+        // Sleep in poll() until Stockfish writes something instead of guessing how long it needs
+        pollfd stdoutPoll = { hStdoutRead, POLLIN, 0 };
+        int ready = poll(&stdoutPoll, 1, static_cast<int>(remaining.count()));
+        if (ready == -1 && errno != EINTR) {
+            std::cerr << "Error waiting for Stockfish output.\n";
+            return false;
+        }
+        if (ready <= 0) {
+            continue;  // Interrupted or timed out, the deadline check above decides
+        }
+        ssize_t bytesRead = read(hStdoutRead, buffer, sizeof(buffer));
+        if (bytesRead == -1 && errno == EINTR) {
+            continue;
+        }
+        if (bytesRead <= 0) {
+            std::cerr << "Error reading from Stockfish.\n";
+            return false;  // The process closed its output or the pipe broke
+        }
 #endif
-        std::stringstream bufferStream(buffer);
-        std::string line;
-        while (std::getline(bufferStream, line)) {
-            lines.push_back(line);
+        outputBuffer.append(buffer, bytesRead);
+    }
+}
+
+// Read until the terminator within the response timeout. After a missed deadline, a live engine is asked to stop
+// and to prove it still responds; a dead or unresponsive engine is killed, so it can be restarted.
+bool Stockfish::readSupervisedOutput(const std::string& terminator, std::vector<std::string>& lines) {
+    lines = readStockfishOutput(terminator, responseTimeout);
+    if (endsWithLine(lines, terminator)) {
+        return true;
+    }
+
+    if (isStockfishAlive()) {
+        // "stop" ends a running search with its best move so far. The engine answers "isready" without waiting for
+        // the stopped search, so "readyok" may come first; drain the answer before asking, or it is read later.
+        {
+            std::lock_guard<std::mutex> searchLock(searchMutex);
+            if (searchRequest) {
+                searchRequest->stopped = true;
+            }
         }
-#ifdef _WIN32
-        if (bytesRead < sizeof(buffer) - 1) break;
+        sendStockfishCommand("stop");
+        std::vector<std::string> stoppedLines = readStockfishOutput(terminator, heartbeatTimeout);
+        const bool answered = endsWithLine(stoppedLines, terminator);
+
+        // "readyok" shows the engine still reads its input; the read first skips an answer that is still missing
+        sendStockfishCommand("isready");
+        if (endsWithLine(readStockfishOutput("readyok", heartbeatTimeout), "readyok")) {
+            if (answered) {
+                lines.insert(lines.end(), stoppedLines.begin(), stoppedLines.end());
+            }
+            return answered;  // Responsive; without its answer the caller replays its request
+        }
+        std::cerr << "Stockfish missed its heartbeat, restarting it.\n";
     }
-#else
-        if (bytesRead < sizeof(buffer) - 1) break;
-        if (bytesRead == -1 && errno != EAGAIN) {
-            std::cerr << "Error reading from Stockfish.\n";
-            break;
+    else {
+        std::cerr << "Stockfish exited, restarting it.\n";
+    }
+
+    terminateStockfish();
+    return false;
+}
+
+// Get Stockfish results after sending a request; a single write and a single read until "bestmove"
+std::vector<std::string> Stockfish::getStockfishResults(const std::string& command, AIRequestToken* token) {
+    std::vector<std::string> lines;
+    if (!hStdinWrite) {
+        return lines;  // Stockfish could not be started
+    }
+    {
+        std::lock_guard<std::mutex> searchLock(searchMutex);
+        if (token && token->cancelled) {
+            return lines;  // Cancelled before its search started
         }
+        searchRequest = token;
+        sendStockfishCommand(command);
+    }
+    {
+        SCOPE_AI_LATENCY(Search);
+        readSupervisedOutput("bestmove", lines);
     }
-#endif
 
+    std::lock_guard<std::mutex> searchLock(searchMutex);
+    searchRequest = nullptr;
     return lines;
 }
 
-// Get Stockfish results after sending a command
-std::vector<std::string> Stockfish::getStockfishResults(const std::string& command) {
-    sendStockfishCommand(command);
-    std::vector<std::string> response = readStockfishOutput();
+// Request Stockfish to analyze a position (FEN string) and return results
+std::vector<std::string> Stockfish::requestStockfish(const int& skillLevel, const std::string& fen, GameSession& session, AIRequestToken* token) {
+    SCOPE_AI_LATENCY(EngineRequest);  // Includes waiting for a request on another thread
+    std::lock_guard<std::mutex> lock(requestMutex);  // Only one request may talk to the engine at a time
+
+    // Time and node limits for this skill level, bounded by the wall-clock budget
+    const SearchLimits limits = limitPolicy.limitsFor(skillLevel);
 
-    // Ensure Stockfish is ready to respond
-    sendStockfishCommand("uci\n");
-    std::vector<std::string> uciResponse = readStockfishOutput();
-    response.insert(response.end(), uciResponse.begin(), uciResponse.end());
+    // Append the move that led to this position to the game, or start a new move list
+    session.update(fen);
 
-    sendStockfishCommand("isready\n");
-    std::vector<std::string> isReadyResponse = readStockfishOutput();
-    response.insert(response.end(), isReadyResponse.begin(), isReadyResponse.end());
+    // Prefer the linked engine: no child process, no pipes and no fixed delays
+    if (StockfishEngine::isAvailable()) {
+        return inProcessEngine.request(skillLevel, fen, session, limits, token);
+    }
 
-    sendStockfishCommand("d\n");  // Display current position information
-    std::vector<std::string> dResponse = readStockfishOutput();
-    response.insert(response.end(), dResponse.begin(), dResponse.end());
+    // A running ponder search either answers the request or has to stop before the engine is reconfigured
+    std::vector<std::string> response;
+    if (resolvePondering(skillLevel, fen, session, limits, response, token)) {
+        return response;
+    }
 
+    startStockfish(skillLevel);  // Start Stockfish with given skill level
+    // "ucinewgame" only for a new game, so the hash table stays warm during a game; the position is sent as the
+    // game's move list. "d" prints the board and FEN, "go perft 1" the legal moves, "go movetime" ends with the best move
+    const std::string search = session.positionCommand() + "\n" + "d" + "\n" + "go perft 1" + "\n" + "go " + limits.toGoArguments();
+    response = getStockfishResults(std::string(session.isNewGame() ? "ucinewgame\n" : "") + search, token);
+
+    // The watchdog killed a dead or stuck engine: start a fresh one and replay the game once
+    if (!endsWithLine(response, "bestmove")) {
+        startStockfish(skillLevel);
+        response = getStockfishResults("ucinewgame\n" + search, token);
+    }
+
+    startPondering(session, skillLevel, limits, response);  // Use the player's thinking time for the expected reply
     return response;
 }
 
-// Request Stockfish to analyze a position (FEN string) and return results
-std::vector<std::string> Stockfish::requestStockfish(const int& skillLevel, const std::string& fen) {
-    startStockfish(skillLevel);  // Start Stockfish with given skill level
-    int depth = 0.5f * skillLevel;  // Adjust depth based on skill level
-    depth = depth < 1 ? 1 : depth;
-    std::string command = "position fen " + fen + "\n" + "go perft 1" + "\n" + "go depth " + std::to_string(depth);
-    std::vector<std::string> response = getStockfishResults(command);
-    return response;
+// Returns the FEN string printed by "d" in a list of Stockfish output lines
+static std::string findFEN(const std::vector<std::string>& lines) {
+    for (const std::string& line : lines) {
+        if (line.compare(0, 5, "Fen: ") == 0) {
+            return line.substr(5);
+        }
+    }
+    return std::string();
+}
+
+// Enable or disable pondering after each request
+void Stockfish::setPondering(const bool& enabled) {
+    ponderingEnabled = enabled;
+    inProcessEngine.setPondering(enabled);
+}
+
+// Use shared memory instead of pipes from the next process start on
+void Stockfish::setSharedMemoryTransport(const bool& enabled) {
+    sharedMemoryEnabled = enabled;
+}
+
+// Start pondering on the position after the best move and the reply Stockfish expects ("bestmove e2e4 ponder e7e5")
+void Stockfish::startPondering(const GameSession& session, const int& skillLevel, const SearchLimits& limits, const std::vector<std::string>& response) {
+    if (!ponderingEnabled || response.empty()) {
+        return;
+    }
+
+    std::istringstream bestMoveLine(response.back());
+    std::string token, bestMove, ponderMove;
+    bestMoveLine >> token >> bestMove >> token >> ponderMove;
+    if (token != "ponder" || ponderMove.empty()) {
+        return;  // Timed out, or the game is over after the best move
+    }
+
+    // Board, FEN and legal moves of both positions first, then the ponder search with the limits of the request.
+    // The node limit applies while pondering: the search then idles until "ponderhit" or "stop", so the answer never
+    // searched more nodes than the skill level allows. The time limit only applies after "ponderhit", measured from "go".
+    {
+        std::lock_guard<std::mutex> searchLock(searchMutex);
+        ponderStopped = false;  // A "stop" from now on reaches the new ponder search
+    }
+    sendStockfishCommand(session.positionCommand({ bestMove }) + "\n" + "d" + "\n" + "go perft 1" + "\n"
+        + session.positionCommand({ bestMove, ponderMove }) + "\n" + "d" + "\n" + "go perft 1" + "\n"
+        + "go ponder " + limits.toGoArguments());
+
+    if (!readSupervisedOutput("Nodes searched", ponderRootResponse) || !readSupervisedOutput("Nodes searched", ponderBoard)) {
+        terminateStockfish();  // The ponder search may be running untracked; the next request starts a fresh engine
+        return;
+    }
+    ponderRootResponse.push_back("bestmove " + ponderMove);
+    ponderRootFEN = findFEN(ponderRootResponse);
+    ponderFEN = findFEN(ponderBoard);
+    ponderSkillLevel = skillLevel;
+    ponderLimits = limits;
+    ponderGame = session;
+    pondering = true;
+}
+
+// Answer a request from the running ponder search, or stop it
+bool Stockfish::resolvePondering(const int& skillLevel, const std::string& fen, const GameSession& session, const SearchLimits& limits,
+    std::vector<std::string>& response, AIRequestToken* token) {
+    if (!pondering) {
+        return false;
+    }
+
+    // Only a request of the same game (usually the same board) continues the ponder search
+    if ((skillLevel == ponderSkillLevel) && (limits.moveTime == ponderLimits.moveTime) && (limits.nodes == ponderLimits.nodes)
+        && session.continues(ponderGame)) {
+        // The position right after Stockfish's own move: the ponder search keeps running
+        if (FENParser::isSamePosition(fen, ponderRootFEN)) {
+            response = ponderRootResponse;
+            return true;
+        }
+
+        // The player made the expected move: the ponder search becomes the real search
+        if (FENParser::isSamePosition(fen, ponderFEN)) {
+            bool ponderHit = false;
+            {
+                std::lock_guard<std::mutex> searchLock(searchMutex);
+                if (token && token->cancelled) {
+                    response.clear();
+                    return true;  // Dropped; the ponder search keeps running for the next request
+                }
+                ponderHit = !ponderStopped;  // After stopStockfish its best move is no answer, only left to drop
+                if (ponderHit) {
+                    searchRequest = token;
+                    sendStockfishCommand("ponderhit");
+                }
+            }
+            if (ponderHit) {
+                std::vector<std::string> searchLines;
+                bool answered = false;
+                {
+                    SCOPE_AI_LATENCY(Search);
+                    answered = readSupervisedOutput("bestmove", searchLines);
+                }
+                {
+                    std::lock_guard<std::mutex> searchLock(searchMutex);
+                    searchRequest = nullptr;
+                }
+                pondering = false;
+                if (!answered) {
+                    return false;  // The watchdog stepped in; the request runs as a normal search
+                }
+
+                response = ponderBoard;
+                response.insert(response.end(), searchLines.begin(), searchLines.end());
+
+                startPondering(session, skillLevel, limits, response);  // The session already contains the player's move
+                return true;
+            }
+        }
+    }
+
+    // Any other position, or a ponder search stopped meanwhile: stop pondering and drop the ponder search's best move
+    sendStockfishCommand("stop");
+    std::vector<std::string> ponderLines;
+    readSupervisedOutput("bestmove", ponderLines);
+    pondering = false;
+    return false;
+}
+
+// Query the legal moves of a position straight from the linked move generator
+bool Stockfish::requestLegalMoves(const std::string& fen, std::vector<uint16_t>& moves) {
+    if (!StockfishEngine::isAvailable()) {
+        return false;
+    }
+    moves = StockfishEngine::legalMoves(fen);
+    return true;
+}
+
+// Stop the running search, if any
+void Stockfish::stopStockfish() {
+    if (StockfishEngine::isAvailable()) {
+        inProcessEngine.stop();
+        return;
+    }
+
+    // The input pipe only exists once startStockfish succeeded
+    std::lock_guard<std::mutex> searchLock(searchMutex);
+    if (hStdinWrite) {
+        if (searchRequest) {
+            searchRequest->stopped = true;  // Its best move so far is not a complete answer
+        }
+        else {
+            ponderStopped = true;  // A ponder search, if one runs, can no longer become the real search
+        }
+        sendStockfishCommand("stop");
+    }
+}
+
+// Stop the search only if it belongs to the request; "stop" would otherwise end whatever search runs right now
+void Stockfish::stopRequest(const AIRequestToken* token) {
+    if (StockfishEngine::isAvailable()) {
+        inProcessEngine.stopRequest(token);
+        return;
+    }
+
+    std::lock_guard<std::mutex> searchLock(searchMutex);
+    if (token && searchRequest == token && hStdinWrite) {
+        searchRequest->stopped = true;
+        sendStockfishCommand("stop");
+    }
+}
+
+// Close the Stockfish process and its handles, but not the in-process engine
+void Stockfish::closeStockfishProcess() {
+    if (StockfishEngine::isAvailable()) {
+        return;  // Requests never start a process while the linked engine is used
+    }
+    stopStockfish();  // Let a pending request finish early instead of waiting for its full search
+    std::lock_guard<std::mutex> lock(requestMutex);
+    terminateStockfish();
 }
 
 // Close Stockfish handles and processes
 void Stockfish::closeStockfish() {
-#ifdef _WIN32
-    if (stockfishMutex) CloseHandle(stockfishMutex);
-#else
-    if (lockFileDescriptor != -1) {
-        flock(lockFileDescriptor, LOCK_UN);  // Unlock the file
-        close(lockFileDescriptor);            // Close the file descriptor
-    }
-    pthread_mutex_destroy(&stockfishMutex); // Clean up mutex
-#endif
+    stopStockfish();  // Let a pending request finish early instead of waiting for its full search
+    std::lock_guard<std::mutex> lock(requestMutex);
+
+    inProcessEngine.close();  // Release the in-process engine, if it was created
+
+    terminateStockfish();  // Ends the Stockfish process, closes the pipes and releases the lock
 }
@@ -0,0 +1,375 @@
+#include "StockfishEngine.h"  // Declares the StockfishEngine class, the in-process backend of the Stockfish wrapper.
+#include "FENParser.h"        // Provides FENParser::isSamePosition for matching requests against the pondered position.
+#include "LatencyProfiler.h"  // Provides the SCOPE_AI_LATENCY timers for the engine start and the search.
+#include <mutex>              // Provides std::once_flag for the one-time initialization of Stockfish's lookup tables.
+#include <sstream>            // Provides std::stringstream for splitting the board visualization into lines.
+#include <string>             // Provides std::string for handling text.
+#include <vector>             // Provides std::vector for storing dynamic arrays.
+
+#if WITH_STOCKFISH_INPROCESS
+// The vendored Stockfish sources are compiled into libstockfish.a; only their headers are needed here.
+// Their directory is added to the include path by LivingRoom.Build.cs.
+THIRD_PARTY_INCLUDES_START
+#include "src/bitboard.h"     // Provides Bitboards::init for the attack lookup tables.
+#include "src/engine.h"       // Provides Stockfish::Engine, the engine used by the UCI executable.
+#include "src/movegen.h"      // Provides MoveList<LEGAL> for generating the legal moves of a position.
+#include "src/position.h"     // Provides Position for setting up a board from a FEN string.
+#include "src/uci.h"          // Provides UCIEngine::format_score for UCI formatted output.
+THIRD_PARTY_INCLUDES_END
+
+// Holds the linked engine and the results its callbacks report for the current search.
+struct StockfishEngine::Impl {
+    Stockfish::Engine engine;  // The Stockfish engine instance, owning its threads, hash table and networks.
+    std::string bestMove;      // The "bestmove" line reported by the last search.
+    std::string bestMoveUCI;   // The best move of the last search in UCI notation.
+    std::string ponderMove;    // The reply the last search expects, empty if there is none.
+    std::string lastInfo;      // The last "info" line reported by the last search.
+    int skillLevel = -1;       // The skill level currently configured on the engine.
+
+    bool pondering = false;                      // True while a "go ponder" search runs; guarded by engineMutex.
+    int ponderSkillLevel = -1;                   // Skill level of the request the ponder search continues.
+    GameSession ponderGame;                      // Game of that request, which may belong to any board.
+    SearchLimits ponderLimits;                   // Limits that apply once the ponder search becomes the real search.
+    std::string ponderFEN;                       // Position being pondered (after the best move and the expected reply).
+    std::vector<std::string> ponderBoard;        // Board and FEN lines of the pondered position.
+    std::string ponderRootFEN;                   // Position after the best move, the root of the ponder search.
+    std::vector<std::string> ponderRootResponse; // Answer for the root position: its board lines and the expected reply.
+};
+
+// Splits the board visualization of the engine's current position into lines, like the output of "d"
+static std::vector<std::string> visualizeLines(const Stockfish::Engine& engine) {
+    std::vector<std::string> lines;
+    std::stringstream boardStream(engine.visualize());
+    std::string line;
+    while (std::getline(boardStream, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+// Stockfish's bitboards and Zobrist keys are global tables that have to be initialized once per process
+static void initializeStockfishTables() {
+    static std::once_flag initialized;
+    std::call_once(initialized, []() {
+        Stockfish::Bitboards::init();
+        Stockfish::Position::init();
+    });
+}
+#else
+// Without the Stockfish library there is nothing to hold
+struct StockfishEngine::Impl {};
+#endif
+
+StockfishEngine::StockfishEngine() {}
+
+StockfishEngine::~StockfishEngine() {
+    close();
+}
+
+// Returns true if the module was linked against the Stockfish library
+bool StockfishEngine::isAvailable() {
+    return WITH_STOCKFISH_INPROCESS != 0;
+}
+
+// Create the engine on first use and configure its settings
+void StockfishEngine::start(const int& skillLevel) {
+#if WITH_STOCKFISH_INPROCESS
+    std::lock_guard<std::mutex> lock(engineMutex);
+    if (!impl) {
+        SCOPE_AI_LATENCY(EngineStart);  // Lookup tables, network, hash table and search threads
+        initializeStockfishTables();
+        impl = std::make_unique<Impl>();
+
+        // Collect the search results through the engine callbacks instead of parsing its standard output
+        Impl* state = impl.get();
+        impl->engine.set_on_update_no_moves([](const Stockfish::Engine::InfoShort&) {});
+        impl->engine.set_on_iter([](const Stockfish::Engine::InfoIter&) {});
+        impl->engine.set_on_update_full([state](const Stockfish::Engine::InfoFull& info) {
+            std::stringstream infoLine;
+            infoLine << "info depth " << info.depth << " seldepth " << info.selDepth
+                << " score " << Stockfish::UCIEngine::format_score(info.score)
+                << " nodes " << info.nodes << " nps " << info.nps << " time " << info.timeMs
+                << " pv " << info.pv;
+            state->lastInfo = infoLine.str();
+        });
+        impl->engine.set_on_bestmove([state](std::string_view bestMove, std::string_view ponder) {
+            state->bestMoveUCI = std::string(bestMove);
+            state->ponderMove = std::string(ponder);
+            state->bestMove = "bestmove " + std::string(bestMove);
+            if (!ponder.empty()) {
+                state->bestMove += " ponder " + std::string(ponder);
+            }
+        });
+
+        impl->engine.get_options()["Threads"] = std::string("2");
+        impl->engine.get_options()["Ponder"] = std::string("true");
+    }
+
+    if (impl->skillLevel != skillLevel) {
+        impl->engine.get_options()["Skill Level"] = std::to_string(skillLevel);
+        impl->skillLevel = skillLevel;
+    }
+#endif
+}
+
+// Warm the engine up with a depth 1 search on the start position
+void StockfishEngine::prewarm(const int& skillLevel) {
+#if WITH_STOCKFISH_INPROCESS
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        if (impl && impl->pondering) {
+            return;  // A ponder search only runs on an engine that is already warm
+        }
+    }
+
+    start(skillLevel);  // Loads the network, allocates the hash table and creates the search threads
+
+    // The first search initializes the threads' data; depth 1 keeps it to a few milliseconds
+    Stockfish::Search::LimitsType searchLimits;
+    searchLimits.startTime = Stockfish::now();
+    searchLimits.depth = 1;
+
+    impl->engine.set_position("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", {});
+    impl->engine.go(searchLimits);
+    impl->engine.wait_for_search_finished();
+
+    // Forget the warm-up search; no ponder search is started for it
+    impl->bestMove.clear();
+    impl->bestMoveUCI.clear();
+    impl->ponderMove.clear();
+    impl->lastInfo.clear();
+#endif
+}
+
+// Analyze a position (FEN string) and return the results in the format of the Stockfish executable
+std::vector<std::string> StockfishEngine::request(const int& skillLevel, const std::string& fen, const GameSession& session, const SearchLimits& limits,
+    AIRequestToken* token) {
+    std::vector<std::string> response;
+#if WITH_STOCKFISH_INPROCESS
+    // A running ponder search either answers the request or has to stop before the engine is reconfigured
+    if (resolvePondering(skillLevel, fen, session, limits, response, token)) {
+        return response;
+    }
+
+    start(skillLevel);  // Create the engine if necessary and apply the skill level
+
+    // Only a new game clears the hash table and histories ("ucinewgame"); during a game they stay warm
+    if (session.isNewGame()) {
+        impl->engine.search_clear();
+    }
+
+    // The whole game instead of a single FEN string, so the engine knows which positions occurred before
+    impl->engine.set_position(session.getStartFEN(), session.getMoves());
+
+    // Board and FEN, formatted like the output of "d"
+    response = visualizeLines(impl->engine);
+
+    // Best move, searched within the same time and node limits the process backend uses
+    Stockfish::Search::LimitsType searchLimits;
+    searchLimits.startTime = Stockfish::now();
+    searchLimits.movetime = limits.moveTime;
+    searchLimits.nodes = limits.nodes;
+
+    impl->bestMove.clear();
+    impl->bestMoveUCI.clear();
+    impl->ponderMove.clear();
+    impl->lastInfo.clear();
+    {
+        SCOPE_AI_LATENCY(Search);
+        {
+            // Checked under the lock stopRequest takes, so a cancellation either drops the request or stops its search
+            std::lock_guard<std::mutex> lock(engineMutex);
+            if (token && token->cancelled) {
+                return std::vector<std::string>();
+            }
+            searchRequest = token;
+            impl->engine.go(searchLimits);
+        }
+        impl->engine.wait_for_search_finished();
+
+        std::lock_guard<std::mutex> lock(engineMutex);
+        searchRequest = nullptr;
+    }
+
+    if (!impl->lastInfo.empty()) {
+        response.push_back(impl->lastInfo);
+    }
+    response.push_back(impl->bestMove);
+
+    startPondering(session, skillLevel, limits);  // Use the player's thinking time for the expected reply
+#endif
+    return response;
+}
+
+// Enable or disable pondering after each search
+void StockfishEngine::setPondering(bool enabled) {
+    ponderingEnabled = enabled;
+}
+
+// Ponder on the position after the best move and the reply the engine expects
+void StockfishEngine::startPondering(const GameSession& session, const int& skillLevel, const SearchLimits& limits) {
+#if WITH_STOCKFISH_INPROCESS
+    if (!ponderingEnabled || impl->ponderMove.empty()) {
+        return;  // Disabled, or the game is over after the best move
+    }
+
+    // The position right after the engine's move, answered with the expected reply while the ponder search runs
+    std::vector<std::string> moves = session.getMoves();
+    moves.push_back(impl->bestMoveUCI);
+    impl->engine.set_position(session.getStartFEN(), moves);
+    impl->ponderRootFEN = impl->engine.fen();
+    impl->ponderRootResponse = visualizeLines(impl->engine);
+    impl->ponderRootResponse.push_back("bestmove " + impl->ponderMove);
+
+    // The position after the expected reply, searched with the limits of the request that just finished
+    moves.push_back(impl->ponderMove);
+    impl->engine.set_position(session.getStartFEN(), moves);
+    impl->ponderFEN = impl->engine.fen();
+    impl->ponderBoard = visualizeLines(impl->engine);
+    impl->ponderSkillLevel = skillLevel;
+    impl->ponderLimits = limits;
+    impl->ponderGame = session;
+
+    // The node limit applies while pondering, after which the search idles until "ponderhit" or "stop"; the time
+    // limit only applies after "ponderhit", measured from here, so a ponder search past it answers immediately
+    Stockfish::Search::LimitsType searchLimits;
+    searchLimits.startTime = Stockfish::now();
+    searchLimits.movetime = limits.moveTime;
+    searchLimits.nodes = limits.nodes;
+    searchLimits.ponderMode = true;
+
+    impl->bestMove.clear();
+    impl->bestMoveUCI.clear();
+    impl->ponderMove.clear();
+    impl->lastInfo.clear();
+
+    std::lock_guard<std::mutex> lock(engineMutex);  // stop() ends the ponder search and drops it under this lock
+    impl->engine.go(searchLimits);
+    impl->pondering = true;
+#endif
+}
+
+// Answer a request from the running ponder search, or stop it
+bool StockfishEngine::resolvePondering(const int& skillLevel, const std::string& fen, const GameSession& session, const SearchLimits& limits,
+    std::vector<std::string>& response, AIRequestToken* token) {
+#if WITH_STOCKFISH_INPROCESS
+    if (!impl) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        if (!impl->pondering) {
+            return false;  // None started, or stop() ended it
+        }
+    }
+
+    // Only a request of the same game (usually the same board) continues the ponder search
+    if ((skillLevel == impl->ponderSkillLevel) && (limits.moveTime == impl->ponderLimits.moveTime) && (limits.nodes == impl->ponderLimits.nodes)
+        && session.continues(impl->ponderGame)) {
+        // The position right after the engine's own move: the ponder search keeps running
+        if (FENParser::isSamePosition(fen, impl->ponderRootFEN)) {
+            response = impl->ponderRootResponse;
+            return true;
+        }
+
+        // The player made the expected move: the ponder search becomes the real search
+        if (FENParser::isSamePosition(fen, impl->ponderFEN)) {
+            {
+                SCOPE_AI_LATENCY(Search);
+                {
+                    std::lock_guard<std::mutex> lock(engineMutex);
+                    if (!impl->pondering) {
+                        return false;  // stop() ended the ponder search meanwhile; its best move is no answer
+                    }
+                    if (token && token->cancelled) {
+                        response.clear();
+                        return true;  // Dropped; the ponder search keeps running for the next request
+                    }
+                    searchRequest = token;
+                    impl->engine.set_ponderhit(false);
+                }
+                impl->engine.wait_for_search_finished();
+
+                std::lock_guard<std::mutex> lock(engineMutex);
+                searchRequest = nullptr;
+                impl->pondering = false;
+            }
+
+            response = impl->ponderBoard;
+            if (!impl->lastInfo.empty()) {
+                response.push_back(impl->lastInfo);
+            }
+            response.push_back(impl->bestMove);
+
+            startPondering(session, skillLevel, limits);  // The session already contains the player's move
+            return true;
+        }
+    }
+
+    // Any other position: stop pondering and search normally
+    impl->engine.stop();
+    impl->engine.wait_for_search_finished();
+
+    std::lock_guard<std::mutex> lock(engineMutex);
+    impl->pondering = false;
+#endif
+    return false;
+}
+
+// Generate the legal moves directly from Stockfish's move generator, instead of running "go perft 1"
+std::vector<std::uint16_t> StockfishEngine::legalMoves(const std::string& fen) {
+    std::vector<std::uint16_t> moves;
+#if WITH_STOCKFISH_INPROCESS
+    initializeStockfishTables();
+
+    Stockfish::StateInfo state;
+    Stockfish::Position position;
+    position.set(fen, false, &state);
+
+    const Stockfish::MoveList<Stockfish::LEGAL> legalMoveList(position);
+    moves.reserve(legalMoveList.size());
+    for (const Stockfish::Move& move : legalMoveList) {
+        moves.push_back(move.raw());
+    }
+#endif
+    return moves;
+}
+
+// Ask the running search to stop; the engine reports its best move so far and request() returns
+void StockfishEngine::stop() {
+#if WITH_STOCKFISH_INPROCESS
+    std::lock_guard<std::mutex> lock(engineMutex);
+    if (impl) {
+        if (searchRequest) {
+            searchRequest->stopped = true;  // Its best move so far is not a complete answer
+        }
+        else {
+            impl->pondering = false;  // A stopped ponder search can no longer become the real search
+        }
+        impl->engine.stop();
+    }
+#endif
+}
+
+// Stop the search only if it belongs to the request; a ponder search or another request's search keeps running
+void StockfishEngine::stopRequest(const AIRequestToken* token) {
+#if WITH_STOCKFISH_INPROCESS
+    std::lock_guard<std::mutex> lock(engineMutex);
+    if (impl && token && searchRequest == token) {
+        searchRequest->stopped = true;
+        impl->engine.stop();
+    }
+#endif
+}
+
+// Stop the search and release the engine
+void StockfishEngine::close() {
+#if WITH_STOCKFISH_INPROCESS
+    std::lock_guard<std::mutex> lock(engineMutex);
+    if (impl) {
+        impl->engine.stop();  // Also ends a ponder search
+        impl->engine.wait_for_search_finished();
+        impl.reset();
+    }
+#endif
+}
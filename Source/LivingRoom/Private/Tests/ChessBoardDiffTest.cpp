@@ -0,0 +1,71 @@
+#include "Misc/AutomationTest.h"  // Provides IMPLEMENT_SIMPLE_AUTOMATION_TEST and the TestEqual/TestTrue checks.
+#include "ChessBoardDiff.h"       // Declares computeBoardDiff, the function under test.
+#include "FENParser.h"            // Provides FENParser::parseFEN for building piece placements from FEN strings.
+#include <vector>                 // Provides std::vector for the list of changes.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Returns the changes between the piece placements of two FEN strings
+static std::vector<ChessBoardChange> diffOf(const char* beforeFEN, const char* afterFEN) {
+    ChessPosition before;
+    ChessPosition after;
+    FENParser::parseFEN(beforeFEN, before);
+    FENParser::parseFEN(afterFEN, after);
+    return computeBoardDiff(before.pieces, after.pieces);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FChessBoardDiffTest, "LivingRoom.Chess.BoardDiff",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FChessBoardDiffTest::RunTest(const FString& Parameters) {
+    // Unchanged placement: nothing to do
+    TestEqual(TEXT("Changes between equal placements"),
+        static_cast<int>(diffOf("4k3/8/8/8/8/8/8/4K3 w - - 0 1", "4k3/8/8/8/8/8/8/4K3 b - - 1 1").size()), 0);
+
+    // exd5: the captured pawn is removed before the capturing pawn arrives on its square
+    const std::vector<ChessBoardChange> capture = diffOf("4k3/8/8/3p4/4P3/8/8/4K3 w - - 0 1", "4k3/8/8/3P4/8/8/8/4K3 b - - 0 1");
+    TestEqual(TEXT("Changes of a capture"), static_cast<int>(capture.size()), 2);
+    if (capture.size() == 2) {
+        TestTrue(TEXT("The captured pawn is removed first"), capture[0].type == ChessBoardChangeType::Remove);
+        TestTrue(TEXT("The captured piece is the black pawn"), capture[0].piece == 'p');
+        TestEqual(TEXT("The captured pawn's square (d5)"), capture[0].fromIndex, 27);
+        TestTrue(TEXT("The capturing pawn moves"), capture[1].type == ChessBoardChangeType::Move);
+        TestEqual(TEXT("The capturing pawn leaves e4"), capture[1].fromIndex, 36);
+        TestEqual(TEXT("The capturing pawn lands on d5"), capture[1].toIndex, 27);
+    }
+
+    // O-O-O: king and rook are both moves, not a removal and an addition
+    const std::vector<ChessBoardChange> castling = diffOf("4k3/8/8/8/8/8/8/R3K3 w Q - 0 1", "4k3/8/8/8/8/8/8/2KR4 b - - 1 1");
+    TestEqual(TEXT("Changes of castling"), static_cast<int>(castling.size()), 2);
+    for (const ChessBoardChange& change : castling) {
+        TestTrue(TEXT("Castling only moves pieces"), change.type == ChessBoardChangeType::Move);
+        if (change.piece == 'K') {
+            TestEqual(TEXT("The king leaves e1"), change.fromIndex, 60);
+            TestEqual(TEXT("The king lands on c1"), change.toIndex, 58);
+        }
+        else {
+            TestEqual(TEXT("The rook leaves a1"), change.fromIndex, 56);
+            TestEqual(TEXT("The rook lands on d1"), change.toIndex, 59);
+        }
+    }
+
+    // b8=N: the pawn is removed and the knight added
+    const std::vector<ChessBoardChange> promotion = diffOf("4k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "1N2k3/8/8/8/8/8/8/4K3 b - - 0 1");
+    TestEqual(TEXT("Changes of a promotion"), static_cast<int>(promotion.size()), 2);
+    if (promotion.size() == 2) {
+        TestTrue(TEXT("The pawn is removed"), promotion[0].type == ChessBoardChangeType::Remove && promotion[0].piece == 'P');
+        TestTrue(TEXT("The knight is added"), promotion[1].type == ChessBoardChangeType::Add && promotion[1].piece == 'N');
+        TestEqual(TEXT("The knight lands on b8"), promotion[1].toIndex, 1);
+    }
+
+    // Two knights move at once (a new board): each is paired with the closest square a knight left
+    const std::vector<ChessBoardChange> knights = diffOf("4k3/8/8/8/8/8/8/1N2K1N1 w - - 0 1", "4k3/8/8/8/8/N6N/8/4K3 w - - 0 1");
+    TestEqual(TEXT("Changes of two knight moves"), static_cast<int>(knights.size()), 2);
+    for (const ChessBoardChange& change : knights) {
+        TestTrue(TEXT("Knights only move"), change.type == ChessBoardChangeType::Move);
+        TestTrue(TEXT("Each knight stays on its side of the board"), (change.fromIndex % 8 < 4) == (change.toIndex % 8 < 4));
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,177 @@
+#include "Misc/AutomationTest.h"  // Provides IMPLEMENT_SIMPLE_AUTOMATION_TEST and the TestEqual/TestTrue checks.
+#include "ChessPieceInstances.h"  // Declares the ChessPieceInstanceMap class under test.
+#include "FENParser.h"            // Provides FENParser::parseFEN for building piece placements from FEN strings.
+#include <algorithm>              // Provides std::copy for the piece placements.
+#include <iterator>               // Provides std::begin and std::end for the fixed-size arrays.
+#include <vector>                 // Provides std::vector for the instance updates.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Board indices of the squares the tests look at (0 = a8 ... 63 = h1)
+static const int A8 = 0, A7 = 8, D5 = 27, E4 = 36, E2 = 52, E1 = 60, F1 = 61, G1 = 62, H1 = 63;
+
+// Piece types in "pnbrqk" order
+static const int PAWN = 0, ROOK = 3, QUEEN = 4, KING = 5;
+
+// Fills a piece placement from the board field of a FEN string
+static void placementOf(const char* fen, char (&placement)[64]) {
+    ChessPosition position;
+    FENParser::parseFEN(fen, position);
+    std::copy(std::begin(position.pieces), std::end(position.pieces), std::begin(placement));
+}
+
+// Applies a position to the map and returns its updates
+static std::vector<ChessPieceInstanceUpdate> updateTo(ChessPieceInstanceMap& instances, const char* fen) {
+    char placement[64];
+    placementOf(fen, placement);
+    return instances.update(placement);
+}
+
+// Checks that exactly the occupied squares have an instance, that each instance exists in its mesh, and that no two
+// pieces of one type share an instance
+static void testConsistent(FAutomationTestBase& test, const ChessPieceInstanceMap& instances, const char* fen) {
+    char placement[64];
+    placementOf(fen, placement);
+
+    bool used[CHESS_PIECE_TYPE_COUNT][64] = {};
+    for (int boardIndex = 0; boardIndex < 64; ++boardIndex) {
+        const int type = ChessPieceInstanceMap::pieceType(placement[boardIndex]);
+        const int instance = instances.instanceAt(boardIndex);
+        if (type < 0) {
+            test.TestEqual(TEXT("An empty square has no instance"), instance, -1);
+            continue;
+        }
+        const bool inMesh = (instance >= 0) && (instance < instances.instanceCount(type)) && (instance < 64);
+        if (test.TestTrue(TEXT("An occupied square has an instance of its mesh"), inMesh)) {
+            test.TestFalse(TEXT("No two pieces share an instance"), used[type][instance]);
+            used[type][instance] = true;
+        }
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FChessPieceInstancesCaptureTest, "LivingRoom.Chess.PieceInstances.Capture",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FChessPieceInstancesCaptureTest::RunTest(const FString& Parameters) {
+    ChessPieceInstanceMap instances;
+
+    // The starting position creates one instance per piece
+    const std::vector<ChessPieceInstanceUpdate> created = updateTo(instances, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    TestEqual(TEXT("Updates for the starting position"), static_cast<int>(created.size()), 32);
+    TestEqual(TEXT("Pawn instances"), instances.instanceCount(PAWN), 16);
+    TestEqual(TEXT("King instances"), instances.instanceCount(KING), 2);
+
+    const int whitePawn = instances.instanceAt(E2);
+    updateTo(instances, "rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 2");
+    TestEqual(TEXT("The e-pawn keeps its instance on e4"), instances.instanceAt(E4), whitePawn);
+
+    // exd5: the black pawn's instance is hidden, the white pawn's instance moves onto its square
+    const int blackPawn = instances.instanceAt(D5);
+    const std::vector<ChessPieceInstanceUpdate> capture = updateTo(instances, "rnbqkbnr/ppp1pppp/8/3P4/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2");
+    TestEqual(TEXT("Updates for a capture"), static_cast<int>(capture.size()), 2);
+    if (capture.size() == 2) {
+        TestEqual(TEXT("The captured pawn is hidden first"), capture[0].boardIndex, -1);
+        TestEqual(TEXT("The hidden instance is the captured pawn's"), capture[0].instance, blackPawn);
+        TestFalse(TEXT("The captured pawn is black"), capture[0].white);
+        TestEqual(TEXT("The capturing pawn lands on d5"), capture[1].boardIndex, D5);
+        TestEqual(TEXT("The capturing pawn keeps its instance"), capture[1].instance, whitePawn);
+        TestFalse(TEXT("A capture creates no instance"), capture[0].created || capture[1].created);
+    }
+    TestEqual(TEXT("e4 is empty"), instances.instanceAt(E4), -1);
+    TestEqual(TEXT("A hidden instance stays in its mesh"), instances.instanceCount(PAWN), 16);
+    testConsistent(*this, instances, "rnbqkbnr/ppp1pppp/8/3P4/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2");
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FChessPieceInstancesPromotionTest, "LivingRoom.Chess.PieceInstances.Promotion",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FChessPieceInstancesPromotionTest::RunTest(const FString& Parameters) {
+    ChessPieceInstanceMap instances;
+    updateTo(instances, "4k3/P7/8/8/8/8/8/4K3 w - - 0 1");
+    const int pawn = instances.instanceAt(A7);
+
+    // a8=Q: the pawn's instance is hidden and the queen gets a new one
+    const std::vector<ChessPieceInstanceUpdate> promotion = updateTo(instances, "Q3k3/8/8/8/8/8/8/4K3 b - - 0 1");
+    TestEqual(TEXT("Updates for a promotion"), static_cast<int>(promotion.size()), 2);
+    if (promotion.size() == 2) {
+        TestEqual(TEXT("The pawn is hidden"), promotion[0].pieceType, PAWN);
+        TestEqual(TEXT("The pawn's instance is hidden"), promotion[0].instance, pawn);
+        TestEqual(TEXT("The pawn leaves the board"), promotion[0].boardIndex, -1);
+        TestEqual(TEXT("The queen appears"), promotion[1].pieceType, QUEEN);
+        TestEqual(TEXT("The queen lands on a8"), promotion[1].boardIndex, A8);
+        TestTrue(TEXT("The first queen creates an instance"), promotion[1].created);
+        TestTrue(TEXT("The queen is white"), promotion[1].white);
+    }
+    TestEqual(TEXT("a7 is empty"), instances.instanceAt(A7), -1);
+    TestEqual(TEXT("Queen instances"), instances.instanceCount(QUEEN), 1);
+    testConsistent(*this, instances, "Q3k3/8/8/8/8/8/8/4K3 b - - 0 1");
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FChessPieceInstancesCastlingTest, "LivingRoom.Chess.PieceInstances.Castling",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FChessPieceInstancesCastlingTest::RunTest(const FString& Parameters) {
+    ChessPieceInstanceMap instances;
+    updateTo(instances, "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1");
+    const int king = instances.instanceAt(E1);
+    const int rook = instances.instanceAt(H1);
+
+    // O-O: king and rook both move and keep their instances
+    const std::vector<ChessPieceInstanceUpdate> castling = updateTo(instances, "r3k2r/8/8/8/8/8/8/R4RK1 b kq - 1 1");
+    TestEqual(TEXT("Updates for castling"), static_cast<int>(castling.size()), 2);
+    for (const ChessPieceInstanceUpdate& update : castling) {
+        TestFalse(TEXT("Castling creates no instance"), update.created);
+        TestTrue(TEXT("Castling hides no instance"), update.boardIndex >= 0);
+    }
+    TestEqual(TEXT("The king keeps its instance on g1"), instances.instanceAt(G1), king);
+    TestEqual(TEXT("The rook keeps its instance on f1"), instances.instanceAt(F1), rook);
+    TestEqual(TEXT("e1 is empty"), instances.instanceAt(E1), -1);
+    TestEqual(TEXT("h1 is empty"), instances.instanceAt(H1), -1);
+    TestEqual(TEXT("Rook instances"), instances.instanceCount(ROOK), 4);
+    TestEqual(TEXT("King instances"), instances.instanceCount(KING), 2);
+    testConsistent(*this, instances, "r3k2r/8/8/8/8/8/8/R4RK1 b kq - 1 1");
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FChessPieceInstancesReuseTest, "LivingRoom.Chess.PieceInstances.Reuse",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FChessPieceInstancesReuseTest::RunTest(const FString& Parameters) {
+    // Promotions and captures; the map does not care whether the moves are legal. Hidden instances are reused before
+    // new ones are created, so each mesh holds as many instances as its type ever had pieces on the board at once.
+    struct Step {
+        const char* fen;
+        int createdInstances;
+    };
+    const Step steps[] = {
+        { "4k3/P6P/8/8/8/8/8/4K3 w - - 0 1", 4 },    // Kings and pawns
+        { "Q3k3/7P/8/8/8/8/8/4K3 b - - 0 1", 1 },    // a8=Q creates the first queen, the a-pawn is hidden
+        { "4k3/7P/8/8/8/8/8/4K3 w - - 0 2", 0 },     // The queen is captured and hidden
+        { "4k2Q/8/8/8/8/8/8/4K3 b - - 0 2", 0 },     // h8=Q reuses the hidden queen, the h-pawn is hidden
+        { "4k3/8/8/8/8/8/P6P/4K3 w - - 0 3", 0 },    // The queen is hidden, both pawns come back from hiding
+        { "Q3k3/8/8/8/8/8/P6P/4K3 b - - 0 3", 0 },   // The queen comes back from hiding
+    };
+
+    ChessPieceInstanceMap instances;
+    for (const Step& step : steps) {
+        int createdInstances = 0;
+        for (const ChessPieceInstanceUpdate& update : updateTo(instances, step.fen)) {
+            createdInstances += update.created ? 1 : 0;
+        }
+        TestEqual(TEXT("Instances created for the position"), createdInstances, step.createdInstances);
+        testConsistent(*this, instances, step.fen);
+    }
+    TestEqual(TEXT("Pawn instances"), instances.instanceCount(PAWN), 2);
+    TestEqual(TEXT("Queen instances"), instances.instanceCount(QUEEN), 1);
+    TestEqual(TEXT("The queen is back in its only instance"), instances.instanceAt(A8), 0);
+
+    // After reset the map starts over, as the cleared meshes do
+    instances.reset();
+    TestEqual(TEXT("No pawn instances after reset"), instances.instanceCount(PAWN), 0);
+    TestEqual(TEXT("No instance on a8 after reset"), instances.instanceAt(A8), -1);
+    return true;
+}
+
+#endif
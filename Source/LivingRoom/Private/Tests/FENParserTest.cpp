@@ -0,0 +1,75 @@
+#include "Misc/AutomationTest.h"  // Provides IMPLEMENT_SIMPLE_AUTOMATION_TEST and the TestEqual/TestTrue checks.
+#include "FENParser.h"            // Declares the FENParser class under test.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFENParserValidTest, "LivingRoom.Chess.FENParser.Valid",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FFENParserValidTest::RunTest(const FString& Parameters) {
+    ChessPosition position;
+    TestTrue(TEXT("Position after 1. e4 c5 2. e5 d5"),
+        FENParser::parseFEN("rnbqkbnr/pp2pppp/8/2ppP3/8/8/PPPP1PPP/RNBQKBNR w KQk d6 0 3", position));
+    TestTrue(TEXT("Black rook on a8"), position.pieces[0] == 'r');
+    TestTrue(TEXT("White pawn on e5"), position.pieces[28] == 'P');
+    TestTrue(TEXT("e2 is empty"), position.isEmpty(52));
+    TestTrue(TEXT("White to move"), position.whitesTurn);
+    TestEqual(TEXT("Castling rights"), position.castlingRights, WhiteKingside | WhiteQueenside | BlackKingside);
+    TestEqual(TEXT("En passant square (d6)"), position.enPassantSquare, 43);
+    TestEqual(TEXT("Half-move clock"), position.halfMoveClock, 0);
+    TestEqual(TEXT("Full-move number"), position.fullMoveNumber, 3);
+    TestTrue(TEXT("Bitboard of the white pawns"), position.pieceBitboards[0] == 0x100000EF00ULL);
+    TestTrue(TEXT("Bitboard of all white pieces"), position.colorBitboards[0] == 0x100000EFFFULL);
+
+    // Extra spaces between the fields are accepted
+    TestTrue(TEXT("Extra spaces"), FENParser::parseFEN("  4k3/8/8/8/8/8/8/4K3   b  -  -  12  40 ", position));
+    TestFalse(TEXT("Black to move"), position.whitesTurn);
+    TestEqual(TEXT("Half-move clock after extra spaces"), position.halfMoveClock, 12);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFENParserMalformedTest, "LivingRoom.Chess.FENParser.Malformed",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FFENParserMalformedTest::RunTest(const FString& Parameters) {
+    const char* const malformed[] = {
+        "",
+        "4k3/8/8/8/8/8/8/4K3 w - - 0",                // Five fields
+        "4k3/8/8/8/8/8/8/4K3 w - - 0 1 extra",        // Seven fields
+        "4k3/8/8/8/8/8/8/4K3/8 w - - 0 1",            // Nine rows
+        "4k3/8/8/8/8/8/8 w - - 0 1",                  // Seven rows
+        "4k4/8/8/8/8/8/8/4K3 w - - 0 1",              // Nine squares in a row
+        "4k2/8/8/8/8/8/8/4K3 w - - 0 1",              // Seven squares in a row
+        "4x3/8/8/8/8/8/8/4K3 w - - 0 1",              // Unknown piece
+        "4k3/8/8/8/8/8/8/4K3 x - - 0 1",              // Unknown side to move
+        "4k3/8/8/8/8/8/8/4K3 w KX - 0 1",             // Unknown castling right
+        "4k3/8/8/8/8/8/8/4K3 w - e3 0 1",             // En passant square behind a white pawn with white to move
+        "4k3/8/8/8/8/8/8/4K3 b - e6 0 1",             // En passant square behind a black pawn with black to move
+        "4k3/8/8/8/8/8/8/4K3 w - i6 0 1",             // En passant square off the board
+        "4k3/8/8/8/8/8/8/4K3 w - - -1 1",             // Negative half-move clock
+        "4k3/8/8/8/8/8/8/4K3 w - - 0 1234567",        // Unreasonably large full-move number
+    };
+
+    for (const char* fen : malformed) {
+        ChessPosition position;
+        TestFalse(TEXT("Malformed FEN string is rejected"), FENParser::parseFEN(fen, position));
+        TestTrue(TEXT("A rejected FEN string leaves the starting position"), position.pieces[4] == 'k' && position.pieces[60] == 'K'
+            && position.pieces[52] == 'P' && position.whitesTurn && position.castlingRights == 0x0F);
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFENParserSamePositionTest, "LivingRoom.Chess.FENParser.SamePosition",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FFENParserSamePositionTest::RunTest(const FString& Parameters) {
+    TestTrue(TEXT("Move clocks and en passant square are ignored"), FENParser::isSamePosition(
+        "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 4 9"));
+    TestFalse(TEXT("Side to move differs"), FENParser::isSamePosition("4k3/8/8/8/8/8/8/4K3 w - - 0 1", "4k3/8/8/8/8/8/8/4K3 b - - 0 1"));
+    TestFalse(TEXT("Castling rights differ"), FENParser::isSamePosition("r3k3/8/8/8/8/8/8/4K3 b q - 0 1", "r3k3/8/8/8/8/8/8/4K3 b - - 0 1"));
+    TestFalse(TEXT("Pieces differ"), FENParser::isSamePosition("4k3/8/8/8/8/8/8/4K3 w - - 0 1", "3k4/8/8/8/8/8/8/4K3 w - - 0 1"));
+    TestFalse(TEXT("A malformed FEN string never matches"), FENParser::isSamePosition("4k3/8/8/8/8/8/8/4K3 w - - 0 1", "4k3/8/8/8 w - - 0 1"));
+    return true;
+}
+
+#endif
@@ -0,0 +1,86 @@
+#include "Misc/AutomationTest.h"  // Provides IMPLEMENT_SIMPLE_AUTOMATION_TEST and the TestEqual/TestTrue checks.
+#include "GameSession.h"          // Declares the GameSession class under test.
+#include "FENParser.h"            // Provides FENParser::parseFEN for the positions of GameSession::findMove.
+#include <string>                 // Provides std::string for moves and position commands.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Returns the move GameSession reconstructs between two FEN strings
+static FString moveBetween(const char* beforeFEN, const char* afterFEN) {
+    ChessPosition before;
+    ChessPosition after;
+    FENParser::parseFEN(beforeFEN, before);
+    FENParser::parseFEN(afterFEN, after);
+    return FString(GameSession::findMove(before, after).c_str());
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGameSessionFindMoveTest, "LivingRoom.Chess.GameSession.FindMove",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FGameSessionFindMoveTest::RunTest(const FString& Parameters) {
+    TestEqual(TEXT("Pawn push"), moveBetween("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1"), TEXT("e2e4"));
+    TestEqual(TEXT("Capture"), moveBetween("4k3/8/8/3p4/4P3/8/8/4K3 w - - 0 1", "4k3/8/8/3P4/8/8/8/4K3 b - - 0 1"), TEXT("e4d5"));
+    TestEqual(TEXT("En passant"), moveBetween("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 2", "4k3/8/3P4/8/8/8/8/4K3 b - - 0 2"), TEXT("e5d6"));
+    TestEqual(TEXT("Kingside castling"), moveBetween("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", "r3k2r/8/8/8/8/8/8/R4RK1 b kq - 1 1"),
+        TEXT("e1g1"));
+    TestEqual(TEXT("Queenside castling"), moveBetween("r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 0 1", "2kr3r/8/8/8/8/8/8/R3K2R w KQ - 1 2"),
+        TEXT("e8c8"));
+    TestEqual(TEXT("Promotion"), moveBetween("4k3/P7/8/8/8/8/8/4K3 w - - 0 1", "Q3k3/8/8/8/8/8/8/4K3 b - - 0 1"), TEXT("a7a8q"));
+    TestEqual(TEXT("Capturing underpromotion"), moveBetween("1r2k3/P7/8/8/8/8/8/4K3 w - - 0 1", "1N2k3/8/8/8/8/8/8/4K3 b - - 0 1"),
+        TEXT("a7b8n"));
+
+    // Positions that are not one move apart
+    TestEqual(TEXT("Same side to move"), moveBetween("4k3/8/8/8/8/8/4P3/4K3 w - - 0 1", "4k3/8/8/8/4P3/8/8/4K3 w - - 0 1"), TEXT(""));
+    TestEqual(TEXT("Two pieces moved"), moveBetween("4k3/8/8/8/8/8/3PP3/4K3 w - - 0 1", "4k3/8/8/8/3PP3/8/8/4K3 b - - 0 1"), TEXT(""));
+    TestEqual(TEXT("The other side moved"), moveBetween("4k3/8/8/8/8/8/4P3/4K3 w - - 0 1", "3k4/8/8/8/8/8/4P3/4K3 b - - 0 1"), TEXT(""));
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGameSessionMoveListTest, "LivingRoom.Chess.GameSession.MoveList",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FGameSessionMoveListTest::RunTest(const FString& Parameters) {
+    GameSession session;
+    session.update("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1");
+    TestTrue(TEXT("The first position starts a new game"), session.isNewGame());
+    TestEqual(TEXT("A game that does not begin at the start position"), FString(session.positionCommand().c_str()),
+        TEXT("position fen rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1"));
+
+    // A game from the starting position is sent as its moves
+    session.startNewGame();
+    session.update("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    TestTrue(TEXT("startNewGame starts a new game"), session.isNewGame());
+    session.update("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1");
+    session.update("rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 2");
+    session.update("rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 2");  // Repeated request, no move
+    TestFalse(TEXT("The game goes on"), session.isNewGame());
+    TestEqual(TEXT("Position command of the game"), FString(session.positionCommand().c_str()),
+        TEXT("position startpos moves e2e4 e7e5"));
+    TestEqual(TEXT("Position command with the moves to ponder"), FString(session.positionCommand({ "g1f3", "b8c6" }).c_str()),
+        TEXT("position startpos moves e2e4 e7e5 g1f3 b8c6"));
+
+    // A later request of the same game continues it, a request of another game does not
+    GameSession later = session;
+    later.update("rnbqkbnr/pppp1ppp/8/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R b KQkq - 1 2");
+    TestTrue(TEXT("The next move continues the game"), later.continues(session));
+    TestFalse(TEXT("An earlier session does not continue a later one"), session.continues(later));
+
+    GameSession other;
+    other.update("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    other.update("rnbqkbnr/pppppppp/8/8/3P4/8/PPP1PPPP/RNBQKBNR b KQkq - 0 1");
+    TestFalse(TEXT("Another game does not continue this one"), other.continues(session));
+
+    // A position that does not follow from the last one starts over from it
+    session.update("4k3/8/8/8/8/8/8/4K3 w - - 0 1");
+    TestEqual(TEXT("The move list restarts from an unrelated position"), static_cast<int>(session.getMoves().size()), 0);
+    TestFalse(TEXT("Starting over within a game is not a new game"), session.isNewGame());
+
+    // Returning to the starting position begins a new game
+    session.update("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    TestTrue(TEXT("The starting position begins a new game"), session.isNewGame());
+    TestEqual(TEXT("Position command of the new game"), FString(session.positionCommand().c_str()), TEXT("position startpos"));
+    return true;
+}
+
+#endif
@@ -0,0 +1,17 @@
+#pragma once  // Ensures this header file is included only once during compilation.
+
+// Includes the CoreMinimal.h header file, which is a central part of the Unreal Engine framework.
+// This header file includes essential core definitions, macros, and types used throughout Unreal Engine.
+// It simplifies includes by aggregating commonly used minimal core components, such as fundamental types,
+// utilities, and standard libraries, reducing the need for multiple individual header file includes.
+#include "CoreMinimal.h"
+
+#include <atomic>  // Provides std::atomic for the flags, which are set and read on different threads.
+
+// Identifies one AI request on its way through the engine pool, so it can be cancelled without touching the
+// searches of other requests. The engine that serves the request remembers its token while the search runs;
+// a cancellation either finds that search and stops it, or the request is dropped before its search starts.
+struct AIRequestToken {
+    std::atomic<bool> cancelled{ false };  // Set by ChessAIHandler::cancelRequest.
+    std::atomic<bool> stopped{ false };    // Set by the engine when it stops the request's search early.
+};
@@ -2,8 +2,12 @@
 
 #include "CoreMinimal.h"                // Includes essential core definitions, macros, and types for Unreal Engine
 #include "Kismet/BlueprintFunctionLibrary.h"  // Includes functionality for creating Blueprint function libraries in Unreal Engine
+#include "ChessAIResponse.h"            // Includes the packed FChessAIResponse struct returned by GetAIResponse
+#include "ChessBoardState.h"            // Includes the packed FChessBoardState struct returned by ParseFENState
 #include "ChessAI.generated.h"          // Includes the generated header file for UChessAI, required for Unreal's build tools
 
+struct AIRequestToken;  // Identifies a single AI request for cancellation, see AIRequestToken.h
+
 // The UCLASS() macro marks this class as a UObject-derived class
 // It makes the class available for use in Unreal Engine and enables features such as reflection
 UCLASS()
@@ -14,15 +18,148 @@ class LIVINGROOM_API UChessAI : public UBlueprintFunctionLibrary
 public:
     // This function retrieves feedback from the AI based on a specified skill level
     // It provides the updated FEN string, the best move, a list of legal moves, and whether it's checkmate
+    // It blocks until the search has finished; gameplay should use the asynchronous GetAIFeedbackAsync node instead
+    // Each board (0, 1, ...) has its own game on the AI side; background requests (hints, analysis) wait for interactive ones
+    UFUNCTION(BlueprintCallable, Category = "Chess")
+    static void GetAIFeedback(const int SkillLevel, const FString CurrentFEN, FString& CorrectedFEN, FString& BestMove, TArray<FString>& LegalMoves, bool& IsCheckmate, bool& IsDrawOfferable, const int Board = 0, const bool Background = false);
+
+    // This function retrieves the same feedback as GetAIFeedback as one packed struct: moves are 16-bit numbers instead of strings
+    // The response is copied without creating a string per move; decode the moves with DecodeAIMove and GetAILegalMove
+    UFUNCTION(BlueprintCallable, Category = "Chess")
+    static void GetAIResponse(const int SkillLevel, const FString CurrentFEN, FChessAIResponse& Response, const int Board = 0, const bool Background = false);
+
+    // This function returns a legal move of an AI response in the packed encoding, or 0 if the index is out of range
+    UFUNCTION(BlueprintPure, Category = "Chess")
+    static int GetAILegalMove(const FChessAIResponse& Response, const int Index);
+
+    // This function decodes a packed move into board indices (0 = a8 ... 63 = h1, like the board returned by ParseFEN)
+    // MoveType is 0 for a normal move, 1 for a promotion, 2 for en passant and 3 for castling; castling returns the king's destination
+    // PromotionPiece is the FEN character of the new piece (upper case for white), or empty if the move is no promotion
+    UFUNCTION(BlueprintPure, Category = "Chess")
+    static void DecodeAIMove(const int Move, int& FromIndex, int& ToIndex, int& MoveType, FString& PromotionPiece);
+
+    // This function converts a packed move into the notation of GetAIFeedback ("e2e4", "e7e8->Q", "e1g1|h1f1", "e5d6-d5")
+    UFUNCTION(BlueprintPure, Category = "Chess")
+    static FString AIMoveToString(const int Move);
+
+    // This function returns the squares the piece on FromIndex can move to (board indices, 0 = a8 ... 63 = h1) for highlighting tiles
+    // The result is precomputed per square, so no move list is searched; castling targets the king's destination
+    // It returns the targets as a bitboard (bit 0 = a1 ... bit 63 = h8) and fills ToIndices with their board indices
+    UFUNCTION(BlueprintCallable, Category = "Chess")
+    static int64 GetAIMoveTargets(const FChessAIResponse& Response, const int FromIndex, TArray<int>& ToIndices);
+
+    // This function checks with a single lookup if moving from FromIndex to ToIndex is legal (board indices, 0 = a8 ... 63 = h1)
+    UFUNCTION(BlueprintPure, Category = "Chess")
+    static bool IsAIMoveLegal(const FChessAIResponse& Response, const int FromIndex, const int ToIndex);
+
+    // This function checks the status flags of an AI response: no legal moves left, and whether a draw can be offered
+    UFUNCTION(BlueprintPure, Category = "Chess")
+    static void GetAIResponseStatus(const FChessAIResponse& Response, bool& IsCheckmate, bool& IsDrawOfferable, bool& WhitesTurn);
+
+    // This function starts the AI on a background thread, e.g. while the level loads, and returns immediately
+    // The engine start, its network, hash table and search threads are then ready before the first AI move
+    UFUNCTION(BlueprintCallable, Category = "Chess")
+    static void Prewarm(const int SkillLevel = 20);
+
+    // This function asks the running AI searches of a board (-1 for all boards) to finish early, so pending feedback requests return quickly
+    // A single asynchronous request started with GetAIFeedbackAsync is cancelled with its own Cancel node instead
+    UFUNCTION(BlueprintCallable, Category = "Chess")
+    static void CancelAIFeedback(const int Board = -1);
+
+    // C++ only: GetAIFeedback for a request that CancelAIRequest can cancel; used by GetAIFeedbackAsync
+    static void GetAIFeedbackForRequest(const int SkillLevel, const FString CurrentFEN, FString& CorrectedFEN, FString& BestMove, TArray<FString>& LegalMoves, bool& IsCheckmate, bool& IsDrawOfferable, const int Board, const bool Background, AIRequestToken* Request);
+
+    // C++ only: cancels one request started with GetAIFeedbackForRequest; it is dropped before its search starts,
+    // or only its own search is stopped, so other requests of the same board are not affected
+    static void CancelAIRequest(AIRequestToken* Request);
+
+    // This function sets how many AI engines may search at the same time (two by default), e.g. for several boards or hints
+    UFUNCTION(BlueprintCallable, Category = "Chess")
+    static void SetAIEngineCount(const int Count);
+
+    // This function tells the AI that a new game starts on a board (-1 for all boards), so it forgets the moves of the previous game
+    // During a game the AI keeps its search state between moves and receives the game's move list
+    UFUNCTION(BlueprintCallable, Category = "Chess")
+    static void StartNewAIGame(const int Board = -1);
+
+    // This function sets the wall-clock budget of an AI search in milliseconds (one second by default)
+    // Lower skill levels use only part of the budget; the budget bounds the reply time on slow machines
+    UFUNCTION(BlueprintCallable, Category = "Chess")
+    static void SetAITimeBudget(const int Milliseconds);
+
+    // This function returns how many milliseconds the last AI feedback request took
+    UFUNCTION(BlueprintPure, Category = "Chess")
+    static int GetLastAIResponseTime();
+
+    // This function enables or disables pondering (enabled by default): while the player thinks, the AI already searches
+    // its answer to the move it expects, so the reply is almost instant if the player makes that move
+    UFUNCTION(BlueprintCallable, Category = "Chess")
+    static void SetAIPondering(const bool Enabled);
+
+    // This function lets the AI processes exchange commands and results through shared memory instead of pipes (disabled by default)
+    // It only applies to the Stockfish executable, not to the linked engine; running AI processes restart with their next request
+    UFUNCTION(BlueprintCallable, Category = "Chess")
+    static void SetAISharedMemoryTransport(const bool Enabled);
+
+    // This function returns how many AI feedback requests were answered from the response cache and how many reached the engine
+    UFUNCTION(BlueprintPure, Category = "Chess")
+    static void GetAICacheStatistics(int64& Hits, int64& Misses, int& CachedResponses);
+
+    // This function sets how many AI responses are cached; the least recently used responses are dropped first
+    UFUNCTION(BlueprintCallable, Category = "Chess")
+    static void SetAICacheCapacity(const int MaximumResponses);
+
+    // This function removes all cached AI responses and resets the cache statistics
+    UFUNCTION(BlueprintCallable, Category = "Chess")
+    static void ClearAICache();
+
+    // This function writes the cached AI responses to a file, so they can be loaded in a later session
+    UFUNCTION(BlueprintCallable, Category = "Chess")
+    static bool SaveAICache(const FString& FilePath);
+
+    // This function loads AI responses written by SaveAICache into the cache
     UFUNCTION(BlueprintCallable, Category = "Chess")
-    static void GetAIFeedback(const int SkillLevel, const FString CurrentFEN, FString& CorrectedFEN, FString& BestMove, TArray<FString>& LegalMoves, bool& IsCheckmate, bool& IsDrawOfferable);
+    static bool LoadAICache(const FString& FilePath);
+
+    // This function returns the 50th, 95th and 99th percentile in milliseconds of a stage of the recent AI requests
+    // Stages: Total, CacheLookup, EngineRequest, EngineStart, CommandWrite, Search, LegalMoves, OutputParsing, FENProcessing
+    // It returns false if the stage does not exist
+    UFUNCTION(BlueprintCallable, Category = "Chess")
+    static bool GetAILatency(const FString& Stage, float& P50, float& P95, float& P99, int& Samples);
+
+    // This function writes the duration of every AI request stage to a CSV file until StopAILatencyTrace is called
+    UFUNCTION(BlueprintCallable, Category = "Chess")
+    static bool StartAILatencyTrace(const FString& FilePath);
+
+    // This function closes the CSV file opened by StartAILatencyTrace
+    UFUNCTION(BlueprintCallable, Category = "Chess")
+    static void StopAILatencyTrace();
+
+    // This function writes count, mean, p50, p95, p99 and maximum of every AI request stage to a JSON file
+    UFUNCTION(BlueprintCallable, Category = "Chess")
+    static bool SaveAILatencySummary(const FString& FilePath);
 
     // This function parses a FEN string and populates various game state details
     // It updates the board layout, whose turn it is, castling rights, en passant target, half-move clock, and full move number
     UFUNCTION(BlueprintCallable, Category = "Chess")
     static void ParseFEN(const FString& fen, TArray<FString>& board, bool& whitesTurn, TArray<bool>& castlingRights, FString& enPassantTarget, int& halfMoveClock, int& fullMoveNumber);
 
+    // This function parses a FEN string into a packed board state without allocating memory, cheap enough to call every frame
+    // It returns false and the starting position if the FEN string is malformed
+    UFUNCTION(BlueprintCallable, Category = "Chess")
+    static bool ParseFENState(const FString& FEN, FChessBoardState& BoardState);
+
+    // This function returns the piece on a square of a parsed board state as a FEN character ("." for an empty square)
+    // The index uses the same order as the board returned by ParseFEN (0 = a8 ... 63 = h1)
+    UFUNCTION(BlueprintPure, Category = "Chess")
+    static FString GetPieceAt(const FChessBoardState& BoardState, const int Index);
+
+    // This function checks if a square of a parsed board state is empty (0 = a8 ... 63 = h1)
+    UFUNCTION(BlueprintPure, Category = "Chess")
+    static bool IsSquareEmpty(const FChessBoardState& BoardState, const int Index);
+
     // This function extracts details from a FEN string, including legal moves and whether a draw offer is possible
+    // Plain UCI moves in LegalMoves are rewritten in the notation of GetAIFeedback (castling, en passant and promotions)
     UFUNCTION(BlueprintCallable, Category = "Chess")
     static void ExtractFENDetails(const FString& fen, TArray<FString>& legalMoves, bool& drawOfferable);
 
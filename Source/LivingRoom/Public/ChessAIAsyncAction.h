@@ -0,0 +1,60 @@
+// This file defines the asynchronous variant of UChessAI::GetAIFeedback, which runs the engine request on a worker thread.
+
+#pragma once
+
+#include "CoreMinimal.h"                            // Core Unreal Engine functionality
+#include "Kismet/BlueprintAsyncActionBase.h"        // Base class for latent Blueprint nodes with output execution pins
+#include "AIRequestToken.h"                         // Identifies the request, so Cancel only stops this request's search
+#include <memory>                                   // Provides std::shared_ptr for the token shared with the worker thread
+#include "ChessAIAsyncAction.generated.h"           // Auto-generated file setup for the async action class
+
+// Delegate fired on the game thread with the same results the synchronous GetAIFeedback returns
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_FiveParams(FChessAIFeedbackDelegate, const FString&, CorrectedFEN, const FString&, BestMove, const TArray<FString>&, LegalMoves, bool, IsCheckmate, bool, IsDrawOfferable);
+
+// Latent Blueprint node that requests AI feedback without blocking the game thread.
+// The engine search runs on a background thread; OnCompleted or OnCancelled fires on the game thread afterwards.
+UCLASS()
+class LIVINGROOM_API UChessAIAsyncAction : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	// Fired with the AI feedback once the request has finished
+	UPROPERTY(BlueprintAssignable, Category = "Chess")
+	FChessAIFeedbackDelegate OnCompleted;
+
+	// Fired instead of OnCompleted if the request was cancelled before it finished
+	UPROPERTY(BlueprintAssignable, Category = "Chess")
+	FChessAIFeedbackDelegate OnCancelled;
+
+	// Starts an AI feedback request for the given skill level and FEN on a worker thread
+	// Requests of different boards run in parallel; background requests (hints, analysis) wait for interactive ones
+	UFUNCTION(BlueprintCallable, Category = "Chess", meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject"))
+	static UChessAIAsyncAction* GetAIFeedbackAsync(UObject* WorldContextObject, const int SkillLevel, const FString CurrentFEN, const int Board = 0, const bool Background = false);
+
+	// Cancels the request; a running search is stopped early and its result is discarded
+	UFUNCTION(BlueprintCallable, Category = "Chess")
+	void Cancel();
+
+	// Called by the Blueprint runtime to start the action
+	virtual void Activate() override;
+
+private:
+	// Broadcasts the results on the game thread and releases the action
+	void Finish(const FString& CorrectedFEN, const FString& BestMove, const TArray<FString>& LegalMoves, bool IsCheckmate, bool IsDrawOfferable);
+
+	// Skill level of the requested search
+	int SkillLevel = 0;
+
+	// Position (FEN string) to analyze
+	FString CurrentFEN;
+
+	// Board the request belongs to
+	int Board = 0;
+
+	// True for hints and analysis, which wait for interactive requests
+	bool bBackground = false;
+
+	// Token of the request, cancelled by Cancel(); shared with the worker thread so it never has to touch the UObject
+	std::shared_ptr<AIRequestToken> Request = std::make_shared<AIRequestToken>();
+};
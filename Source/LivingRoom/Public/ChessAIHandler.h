@@ -5,48 +5,110 @@
 // It simplifies includes by aggregating commonly used minimal core components, such as fundamental types,
 // utilities, and standard libraries, reducing the need for multiple individual header file includes.
 #include "CoreMinimal.h"
+#include "AIRequestToken.h" // Declares the AIRequestToken struct, which lets a single request be cancelled.
+#include "ChessMove.h"  // Declares the ChessMove struct, a move in Stockfish's packed 16-bit encoding.
+#include "EnginePool.h" // Declares the AIRequestPriority enum deciding which waiting request gets the next free engine.
 
-#include <string>  // Provides std::string for managing text strings.
-#include <vector>  // Provides std::vector for handling dynamic arrays.
+#include <atomic>   // Provides std::atomic for the last response time, which may be read from any thread.
+#include <cstdint>  // Provides std::uint8_t and std::uint16_t for the packed response.
+#include <string>   // Provides std::string for managing text strings.
+#include <vector>   // Provides std::vector for handling dynamic arrays.
 
-// A structure to store the response from Stockfish.
-// Contains details about the best move, legal moves, board state, FEN, and game status.
+// Status flags of a StockfishResponse.
+enum ChessResponseFlag : std::uint8_t {
+    ResponseCheckmate = 1 << 0,      // The side to move has no legal moves.
+    ResponseDrawOfferable = 1 << 1,  // Fifty moves without capture or pawn move: a draw can be offered.
+    ResponseWhitesTurn = 1 << 2      // White is to move.
+};
+
+// Capacity of StockfishResponse::legalMoves; no chess position has more than 218 legal moves.
+constexpr int MAX_LEGAL_MOVES = 256;
+
+// A structure to store the response from Stockfish, packed into fixed-size fields, so producing, caching and
+// copying a response needs no allocation besides the FEN string.
+// Moves use the packed 16-bit encoding of ChessMove, whose type bits mark castling, en passant and promotions.
 struct StockfishResponse {
-    std::string bestMove;  // The best move recommended by Stockfish.
-    std::vector<std::string> legalMoves;  // List of all legal moves according to Stockfish.
-    std::vector<std::string> board;  // Board representation as a list of strings.
-    std::string fen;  // FEN string representing the current board state.
-    bool isCheckmate = false;  // Indicates if the position is checkmate.
-    bool drawOfferable = false;  // Indicates if a draw can be offered.
+    ChessMove bestMove;                     // The best move recommended by Stockfish; invalid if the search returned none.
+    ChessMove legalMoves[MAX_LEGAL_MOVES];  // All legal moves of the position, the first legalMoveCount entries are used.
+    std::uint16_t legalMoveCount = 0;       // Number of legal moves.
+    ChessMoveTargets moveTargets;           // Destinations of the legal moves by origin square, for highlighting and validation.
+    char board[64] = {};                    // FEN character of the piece on each square ('.' if empty), 0 = a8 ... 63 = h1.
+    std::string fen;                        // FEN string representing the current board state.
+    std::uint8_t flags = 0;                 // Combination of ChessResponseFlag values.
+    int responseTime = 0;                   // Wall-clock time in milliseconds it took to produce this response.
+
+    bool isCheckmate() const { return (flags & ResponseCheckmate) != 0; }
+    bool isDrawOfferable() const { return (flags & ResponseDrawOfferable) != 0; }
+    bool whitesTurn() const { return (flags & ResponseWhitesTurn) != 0; }
+
+    // Appends a legal move and its destination; moves beyond MAX_LEGAL_MOVES are dropped.
+    void addLegalMove(const ChessMove& move) {
+        if (legalMoveCount < MAX_LEGAL_MOVES) {
+            legalMoves[legalMoveCount++] = move;
+            moveTargets.add(move);
+        }
+    }
 };
 
 // Class to handle interactions with the chess AI and process Stockfish responses.
+// Requests run on an engine of the EnginePool, so several threads may call getChessAIFeedback at the same time.
 class LIVINGROOM_API ChessAIHandler {
 public:
     // Retrieves feedback from the chess AI based on skill level and FEN string.
     // Returns a StockfishResponse object containing details about the best move, legal moves, board state, and more.
-    StockfishResponse getChessAIFeedback(const int& skill_level, const std::string& fen);
+    // Interactive requests get the next free engine before background requests (hints, analysis); requests of the
+    // same board prefer the same engine, so it keeps the game's move list and can ponder.
+    // A request with a token can be cancelled with cancelRequest; a cancelled request returns an empty response.
+    StockfishResponse getChessAIFeedback(const int& skill_level, const std::string& fen,
+        AIRequestPriority priority = AIRequestPriority::Interactive, int board = 0, AIRequestToken* token = nullptr);
 
     // Prints the information contained in a StockfishResponse object.
     // The 'toPrint' parameter specifies what information to print (e.g., "Board", "BestMove", "LegalMoves", "FEN", or "All").
     void printStockfishResponse(const StockfishResponse& response, const std::string& toPrint = "All");
 
-    // Close all open stockfish connections and handles
-    void closeStockfish();
-private:
-    // Extracts detailed information from the raw Stockfish response.
-    // Parses a vector of response lines to populate a StockfishResponse object.
-    StockfishResponse extractResponse(const std::vector<std::string>& response);
+    // Starts the engine and runs a minimal search ahead of the first request. Blocks; call it from a worker thread.
+    void prewarmChessAI(const int& skillLevel);
+
+    // Asks the running AI searches of a board (-1: all boards) to finish early, so pending getChessAIFeedback calls
+    // return quickly. Can be called from any thread.
+    void stopChessAI(int board = -1);
 
-    // Checks if a response line contains the best move and updates the bestMove variable.
-    void checkForBestMove(const std::string& line, std::string& bestMove);
+    // Cancels the getChessAIFeedback call that was given this token: it is dropped if its search has not started
+    // yet, otherwise only its own search is stopped. Can be called from any thread.
+    void cancelRequest(AIRequestToken* token);
 
-    // Checks if a response line contains legal moves and updates the legalMoves vector.
-    void checkForLegalMoves(const std::string& line, std::vector<std::string>& legalMoves);
+    // Sets how many engines may search in parallel (at least 1, defaults to 2).
+    void setEngineCount(const int& count);
 
-    // Checks if a response line contains a part of the board representation and updates the board vector.
-    void checkForBoardPart(const std::string& line, std::vector<std::string>& board);
+    // Starts a new game on a board (-1: all boards): the board's game forgets the previous moves and the engine
+    // serving its next request clears its hash table.
+    void startNewGame(const int& board = -1);
 
-    // Checks if a response line contains the FEN string and updates the fen variable.
-    void checkForFen(const std::string& line, std::string& fen);
+    // Sets the wall-clock budget of an engine search in milliseconds; the skill level decides how much of it is used.
+    void setSearchTimeBudget(const int& milliseconds);
+
+    // Returns the wall-clock time in milliseconds the last getChessAIFeedback call took.
+    int getLastResponseTime() const;
+
+    // Enables or disables pondering: the engine searches the expected reply while the player is thinking.
+    void setPondering(const bool& enabled);
+
+    // Enables or disables the shared memory transport to Stockfish processes (see Stockfish::setSharedMemoryTransport).
+    // Engines that are already running keep their transport until they are closed.
+    void setSharedMemoryTransport(const bool& enabled);
+
+    // Close all open stockfish connections and handles
+    void closeStockfish();
+
+    // Close the Stockfish processes only; the linked in-process engines keep running
+    void closeStockfishProcesses();
+private:
+    // Wall-clock time of the last getChessAIFeedback call in milliseconds.
+    std::atomic<int> lastResponseTime{ 0 };
+
+    // Extracts detailed information from the raw Stockfish response.
+    // Parses a vector of response lines to populate a StockfishResponse object: the FEN from the "Fen: " line,
+    // then the board, the status flags and the moves decoded against that position.
+    // If the result already holds legal moves (from the linked move generator), the "go perft 1" lines are skipped.
+    void extractResponse(const std::vector<std::string>& response, StockfishResponse& result);
 };
\ No newline at end of file
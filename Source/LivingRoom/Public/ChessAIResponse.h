@@ -0,0 +1,49 @@
+// This file defines the packed AI response that Blueprint receives from UChessAI::GetAIResponse.
+
+#pragma once
+
+#include "CoreMinimal.h"                            // Core Unreal Engine functionality
+#include "ChessAIResponse.generated.h"              // Auto-generated file setup for the response struct
+
+// Packed view of an AI response, copied from the plain C++ StockfishResponse with a few memcpy calls.
+// Moves use the packed 16-bit encoding of ChessMove: bits 0-5 destination, bits 6-11 origin (0 = a1 ... 63 = h8),
+// bits 12-13 promotion piece and bits 14-15 the move type. Blueprint decodes them with UChessAI::DecodeAIMove.
+// Pieces use the board index of the legacy board array (0 = a8 ... 63 = h1).
+USTRUCT(BlueprintType)
+struct LIVINGROOM_API FChessAIResponse
+{
+	GENERATED_BODY()
+
+	// FEN string of the position as corrected by the engine
+	UPROPERTY(BlueprintReadOnly, Category = "Chess")
+	FString CorrectedFEN;
+
+	// Best move in the packed encoding, 0 if the engine returned none
+	UPROPERTY(BlueprintReadOnly, Category = "Chess")
+	int32 BestMove = 0;
+
+	// All legal moves in the packed encoding; the first LegalMoveCount entries are used
+	UPROPERTY()
+	uint16 LegalMoves[256] = {};
+
+	// Number of legal moves
+	UPROPERTY(BlueprintReadOnly, Category = "Chess")
+	int32 LegalMoveCount = 0;
+
+	// Destinations of the legal moves as one bitboard per origin square (index and bits 0 = a1 ... 63 = h8)
+	// Blueprint queries them through UChessAI::GetAIMoveTargets and UChessAI::IsAIMoveLegal
+	UPROPERTY()
+	int64 MoveTargets[64] = {};
+
+	// FEN character of the piece on each square ('.' for an empty square)
+	UPROPERTY()
+	uint8 Pieces[64] = {};
+
+	// Status flags: 1 = checkmate (no legal moves), 2 = a draw can be offered, 4 = white is to move
+	UPROPERTY(BlueprintReadOnly, Category = "Chess")
+	uint8 Flags = 0;
+
+	// Wall-clock time in milliseconds it took to produce the response
+	UPROPERTY(BlueprintReadOnly, Category = "Chess")
+	int32 ResponseTime = 0;
+};
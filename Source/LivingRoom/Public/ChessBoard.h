@@ -8,6 +8,7 @@
 #include "ChessTile.h"                                                   // ChessTile class, representing individual tiles on the chessboard
 #include "ChessPiece.h"                                                  // ChessPiece class, representing individual chess pieces
 #include "ChessAI.h"                                                     // ChessAI class, handling chess-related logic and AI
+#include "ChessPieceInstances.h"                                         // ChessPieceInstanceMap, mapping squares to instances of the piece meshes
 #include "ChessBoard.generated.h"                                        // Auto-generated file setup for the chessboard class
 
 // Class that represents the chessboard and handles chess tile/piece management
@@ -52,6 +53,10 @@ public:
 	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Chess")
 	TArray<FString> FieldLetters = { "a", "b", "c", "d", "e", "f", "g", "h" };
 
+	// Chess pieces placed by UpdateBoardFromFEN, indexed by board position (0 = a8 ... 63 = h1, nullptr for empty fields)
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Chess")
+	TArray<AChessPiece*> PiecesOnBoard;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
@@ -60,10 +65,39 @@ private:
 	// Calculates the position of each chess tile based on its letter and number index
 	FVector CalculateFieldLocation(int LetterIndex, int NumberIndex);
 
-public:
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	// Returns the location of a field by its board position index (0-63), without a string lookup
+	FVector GetFieldLocation(int Index) const;
+
+	// Takes a hidden chess piece of the right class from the pool, or spawns a new one if the pool has none
+	AChessPiece* AcquireChessPiece(char FENChar, int Index);
+
+	// Hides a chess piece that left the board and keeps it in the pool for later reuse
+	void ReleaseChessPiece(AChessPiece* ChessPiece);
+
+	// Moves a chess piece onto a field and turns it towards the opponent
+	void PlaceChessPiece(AChessPiece* ChessPiece, char FENChar, int Index);
+
+	// Field locations indexed by board position (0 = a8 ... 63 = h1), filled together with FieldLocations
+	TArray<FVector> FieldLocationsByIndex;
+
+	// Hidden chess pieces that were removed from the board and can be reused instead of spawning new actors
+	UPROPERTY()
+	TArray<AChessPiece*> PooledPieces;
+
+	// FEN characters of the pieces currently on the board ('.' for empty fields), used to compute the next diff
+	char CurrentPlacement[64];
 
+	// One instanced mesh per piece type (pawn, knight, bishop, rook, queen, king), set by SetPieceInstanceComponents
+	UPROPERTY()
+	TArray<UHierarchicalInstancedStaticMeshComponent*> PieceInstanceComponents;
+
+	// Which instance of which mesh draws the piece on each field, while the pieces are drawn as instances
+	ChessPieceInstanceMap PieceInstances;
+
+	// Moves, hides and adds mesh instances so they show the new piece placement
+	void UpdateInstancedPieces(const char (&Placement)[64]);
+
+public:
 	// Function to construct the checkboard pattern with light and dark tiles
 	UFUNCTION(BlueprintCallable, Category = "Chess")
 	void ConstructCheckboardPattern(UHierarchicalInstancedStaticMeshComponent* LightTiles, UHierarchicalInstancedStaticMeshComponent* DarkTiles);
@@ -79,4 +113,19 @@ public:
 	// Spawns chess pieces on the board according to the provided FEN string
 	UFUNCTION(BlueprintCallable, Category = "Chess")
 	AChessPiece* SpawnChessPieceOnBoard(const FString FENChar, const int Index);
+
+	// Updates the pieces on the board to match the provided FEN string
+	// Only the pieces that changed are moved, taken from or returned to a pool of hidden actors; nothing is respawned
+	// After SetPieceInstanceComponents the pieces are mesh instances instead, and PiecesOnBoard stays empty
+	UFUNCTION(BlueprintCallable, Category = "Chess")
+	void UpdateBoardFromFEN(const FString& FEN);
+
+	// Draws the pieces through one instanced static mesh per piece type instead of one actor per piece, the same way
+	// ConstructCheckboardPattern draws the tiles: 32 pieces then cost six instanced draws and no ticks
+	// White and black pieces share a mesh; the first custom data value of an instance is 0 for white and 1 for black,
+	// so the pieces' material has to pick its color from PerInstanceCustomData[0]
+	UFUNCTION(BlueprintCallable, Category = "Chess")
+	void SetPieceInstanceComponents(UHierarchicalInstancedStaticMeshComponent* Pawns, UHierarchicalInstancedStaticMeshComponent* Knights,
+		UHierarchicalInstancedStaticMeshComponent* Bishops, UHierarchicalInstancedStaticMeshComponent* Rooks,
+		UHierarchicalInstancedStaticMeshComponent* Queens, UHierarchicalInstancedStaticMeshComponent* Kings);
 };
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once  // Ensures this header file is included only once during compilation.
+
+// Includes the CoreMinimal.h header file, which is a central part of the Unreal Engine framework.
+// This header file includes essential core definitions, macros, and types used throughout Unreal Engine.
+// It simplifies includes by aggregating commonly used minimal core components, such as fundamental types,
+// utilities, and standard libraries, reducing the need for multiple individual header file includes.
+#include "CoreMinimal.h"
+
+#include <cstdint>  // Provides std::int8_t for compact square indices.
+#include <vector>   // Provides std::vector for the list of changes.
+
+// Kinds of changes needed to turn one piece placement into another.
+enum class ChessBoardChangeType : std::uint8_t {
+    Remove,  // A piece leaves the board (captured, or replaced by its promotion piece).
+    Move,    // A piece moves from one square to another.
+    Add      // A piece appears on the board (promotion piece, or any piece on a new board).
+};
+
+// A single change between two piece placements. Squares use the board index of the piece array (0 = a8 ... 63 = h1).
+struct ChessBoardChange {
+    ChessBoardChangeType type;  // What happens to the piece.
+    char piece;                 // FEN character of the piece.
+    std::int8_t fromIndex;      // Square the piece leaves (-1 for Add).
+    std::int8_t toIndex;        // Square the piece lands on (-1 for Remove).
+};
+
+// Computes the minimal set of changes that turns the piece placement 'before' into 'after' (64 FEN characters each,
+// '.' for an empty square, as in ChessPosition::pieces). Pieces that only moved, including both pieces of a castling
+// move, become Move changes, so their actors can be relocated instead of respawned. Captured pieces become Remove
+// changes and promotions become a Remove of the pawn plus an Add of the new piece.
+// Changes are ordered Remove, Move, Add, so captured pieces are gone before other pieces arrive on their squares.
+LIVINGROOM_API std::vector<ChessBoardChange> computeBoardDiff(const char (&before)[64], const char (&after)[64]);
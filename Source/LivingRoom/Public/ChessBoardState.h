@@ -0,0 +1,51 @@
+// This file defines the packed board state that Blueprint receives from UChessAI::ParseFENState.
+
+#pragma once
+
+#include "CoreMinimal.h"                            // Core Unreal Engine functionality
+#include "ChessBoardState.generated.h"              // Auto-generated file setup for the board state struct
+
+// Packed view of a parsed FEN string, copied from the plain C++ ChessPosition without any heap allocation.
+// Pieces use the board index of the legacy board array (0 = a8 ... 63 = h1), bitboards use bit 0 = a1 ... bit 63 = h8.
+// Blueprint reads the pieces through UChessAI::GetPieceAt and UChessAI::IsSquareEmpty.
+USTRUCT(BlueprintType)
+struct LIVINGROOM_API FChessBoardState
+{
+	GENERATED_BODY()
+
+	// FEN character of the piece on each square ('.' for an empty square)
+	UPROPERTY()
+	uint8 Pieces[64] = {};
+
+	// One bitboard per piece type, in the order P, N, B, R, Q, K, p, n, b, r, q, k
+	UPROPERTY()
+	int64 PieceBitboards[12] = {};
+
+	// Bitboard of all squares occupied by white pieces
+	UPROPERTY(BlueprintReadOnly, Category = "Chess")
+	int64 WhitePieces = 0;
+
+	// Bitboard of all squares occupied by black pieces
+	UPROPERTY(BlueprintReadOnly, Category = "Chess")
+	int64 BlackPieces = 0;
+
+	// True if white is to move
+	UPROPERTY(BlueprintReadOnly, Category = "Chess")
+	bool WhitesTurn = true;
+
+	// Castling rights as flags: 1 = white kingside, 2 = white queenside, 4 = black kingside, 8 = black queenside
+	UPROPERTY(BlueprintReadOnly, Category = "Chess")
+	uint8 CastlingRights = 0;
+
+	// Square behind a pawn that just moved two squares (0 = a1 ... 63 = h8), or -1 if there is none
+	UPROPERTY(BlueprintReadOnly, Category = "Chess")
+	int32 EnPassantSquare = -1;
+
+	// Half-moves since the last capture or pawn move
+	UPROPERTY(BlueprintReadOnly, Category = "Chess")
+	int32 HalfMoveClock = 0;
+
+	// Number of the current full move
+	UPROPERTY(BlueprintReadOnly, Category = "Chess")
+	int32 FullMoveNumber = 1;
+};
@@ -0,0 +1,86 @@
+#pragma once  // Ensures this header file is included only once during compilation.
+
+// Includes the CoreMinimal.h header file, which is a central part of the Unreal Engine framework.
+// This header file includes essential core definitions, macros, and types used throughout Unreal Engine.
+// It simplifies includes by aggregating commonly used minimal core components, such as fundamental types,
+// utilities, and standard libraries, reducing the need for multiple individual header file includes.
+#include "CoreMinimal.h"
+
+#include <cstdint>      // Provides std::uint16_t for the packed move encoding.
+#include <string>       // Provides std::string for the UCI notation of a move.
+#include <string_view>  // Provides std::string_view for decoding moves without copying them.
+
+// Declared in FENParser.h; decoding a UCI move needs the position to recognize castling and en passant.
+struct ChessPosition;
+
+// Move types stored in the two highest bits of a packed move, identical to Stockfish's MoveType.
+enum class ChessMoveType : std::uint16_t {
+    Normal = 0,
+    Promotion = 1 << 14,
+    EnPassant = 2 << 14,
+    Castling = 3 << 14
+};
+
+// A move in Stockfish's packed 16-bit encoding, so moves can be handed over from the engine without any text:
+// bits 0-5 hold the destination square, bits 6-11 the origin square, bits 12-13 the promotion piece
+// (knight, bishop, rook, queen) and bits 14-15 the move type. Squares are numbered a1 = 0, b1 = 1, ..., h8 = 63.
+// Like in Stockfish, castling is encoded as the king capturing its own rook (e.g. e1h1 for white kingside).
+struct LIVINGROOM_API ChessMove {
+    std::uint16_t data = 0;  // The packed move.
+
+    ChessMove() = default;
+    explicit ChessMove(std::uint16_t packedMove) : data(packedMove) {}
+
+    // Decodes a move in UCI notation (e.g. "e2e4", "e1g1", "e7e8q") played in the given position. The position
+    // decides whether a king move is castling and a pawn move en passant. Returns an invalid move for malformed text.
+    static ChessMove fromUCI(std::string_view uci, const ChessPosition& position);
+
+    // False for the empty move (data 0) and Stockfish's null move, which start and end on the same square.
+    bool isValid() const { return fromSquare() != toSquare(); }
+
+    // Square the moving piece starts on (0-63, a1 = 0).
+    int fromSquare() const { return (data >> 6) & 0x3F; }
+
+    // Square the moving piece lands on (0-63, a1 = 0). For castling this is the rook's square.
+    int toSquare() const { return data & 0x3F; }
+
+    // The move type stored in the two highest bits.
+    ChessMoveType type() const { return static_cast<ChessMoveType>(data & (3 << 14)); }
+
+    bool isPromotion() const { return type() == ChessMoveType::Promotion; }
+    bool isEnPassant() const { return type() == ChessMoveType::EnPassant; }
+    bool isCastling() const { return type() == ChessMoveType::Castling; }
+
+    // Lowercase FEN character of the piece a pawn promotes to ('n', 'b', 'r' or 'q').
+    char promotionPiece() const { return "nbrq"[(data >> 12) & 3]; }
+
+    // Square the king lands on when castling (g- or c-file), otherwise the destination square.
+    int kingDestinationSquare() const;
+
+    // Returns the move in standard UCI notation (e.g. "e2e4", "e1g1", "e7e8q").
+    std::string toUCI() const;
+
+    // Returns the move in the notation the game's Blueprints expect: "e2e4", "e7e8->Q" for promotions (upper case
+    // for white), "e1g1|h1f1" for castling (king move, then rook move) and "e5d6-d5" for en passant (followed by
+    // the square of the captured pawn).
+    std::string toGameNotation() const;
+
+    // Returns the name of a square (0-63) in algebraic notation (e.g. 4 -> "e1").
+    static std::string squareName(int square);
+};
+
+// Destinations of the legal moves of a position as one bitboard per origin square (bit 0 = a1 ... bit 63 = h8),
+// so the targets of a piece and the legality of a move are single lookups instead of a search through the move list.
+// Castling is stored with the king's destination (e.g. e1 -> g1), the square the player clicks.
+struct LIVINGROOM_API ChessMoveTargets {
+    std::uint64_t targets[64] = {};  // Destination bitboard of each origin square.
+
+    // Adds the destination of a legal move.
+    void add(const ChessMove& move) { targets[move.fromSquare()] |= std::uint64_t(1) << move.kingDestinationSquare(); }
+
+    // Returns the bitboard of all squares the piece on 'square' can move to (0-63, a1 = 0).
+    std::uint64_t of(int square) const { return targets[square & 63]; }
+
+    // Returns true if a legal move leads from 'from' to 'to' (0-63, a1 = 0).
+    bool contains(int from, int to) const { return (targets[from & 63] >> (to & 63)) & 1; }
+};
@@ -7,6 +7,7 @@
 #include "ChessPiece.generated.h"                   // Auto-generated file setup for the chess piece class
 
 // Class representing a chess piece, such as a pawn, rook, knight, etc.
+// Pieces never tick; AChessBoard::SetPieceInstanceComponents replaces the actors with instanced meshes altogether
 UCLASS()
 class LIVINGROOM_API AChessPiece : public ACharacter
 {
@@ -21,9 +22,6 @@ protected:
 	virtual void BeginPlay() override;
 
 public:
-	// Function called every frame to update the chess piece (e.g., for animations or movements)
-	virtual void Tick(float DeltaTime) override;
-
 	// Function called to bind input controls (like movement or actions) to the chess piece
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
@@ -0,0 +1,53 @@
+#pragma once  // Ensures this header file is included only once during compilation.
+
+// Includes the CoreMinimal.h header file, which is a central part of the Unreal Engine framework.
+// This header file includes essential core definitions, macros, and types used throughout Unreal Engine.
+// It simplifies includes by aggregating commonly used minimal core components, such as fundamental types,
+// utilities, and standard libraries, reducing the need for multiple individual header file includes.
+#include "CoreMinimal.h"
+
+#include <cstdint>  // Provides std::int8_t and std::int16_t for compact indices.
+#include <vector>   // Provides std::vector for the list of instance updates and the free instances.
+
+// Number of piece types; each type is drawn by one instanced mesh, white and black pieces alike.
+constexpr int CHESS_PIECE_TYPE_COUNT = 6;
+
+// What happens to one mesh instance when the pieces on the board change.
+struct ChessPieceInstanceUpdate {
+    std::int8_t pieceType;   // Index of the piece type in "pnbrqk" (pawn, knight, bishop, rook, queen, king).
+    std::int16_t instance;   // Index of the instance within the mesh of its piece type.
+    std::int8_t boardIndex;  // Square the instance moves to (0 = a8 ... 63 = h1), or -1 to hide it.
+    bool white;              // Color of the piece, written into the instance's custom data.
+    bool created;            // True if the instance is new and has to be added to the mesh first.
+};
+
+// Maps the squares of the board to instances of one instanced mesh per piece type, so the pieces can be drawn
+// with a handful of instanced draws instead of one actor each. Instances are never removed from a mesh: a captured
+// piece's instance is hidden and reused by the next piece of that type, so instance indices stay stable.
+// Plain C++ without engine types; AChessBoard applies the updates to its instanced static mesh components.
+class LIVINGROOM_API ChessPieceInstanceMap {
+public:
+    ChessPieceInstanceMap();
+
+    // Returns the piece type of a FEN character (0 = pawn ... 5 = king, for both colors), or -1 for an empty square.
+    static int pieceType(char fenChar);
+
+    // Changes the mapping to a new piece placement (64 FEN characters, '.' for an empty square, 0 = a8) and returns
+    // the instance updates that make the meshes match it. Pieces that moved keep their instance.
+    std::vector<ChessPieceInstanceUpdate> update(const char (&placement)[64]);
+
+    // Returns the instance drawing the piece on a square (0 = a8 ... 63 = h1), or -1 if the square is empty.
+    int instanceAt(int boardIndex) const;
+
+    // Returns the number of instances a piece type's mesh holds, visible and hidden.
+    int instanceCount(int pieceType) const;
+
+    // Forgets all instances; call it after the meshes were cleared.
+    void reset();
+
+private:
+    char currentPlacement[64];                                      // Placement the instances currently show.
+    std::int16_t instanceOnSquare[64];                              // Instance of the piece on each square, or -1.
+    int instanceCounts[CHESS_PIECE_TYPE_COUNT];                     // Instances created per piece type.
+    std::vector<std::int16_t> hiddenInstances[CHESS_PIECE_TYPE_COUNT];  // Hidden instances ready for reuse.
+};
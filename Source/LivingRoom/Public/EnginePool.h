@@ -0,0 +1,174 @@
+#pragma once  // Ensures this header file is included only once during compilation.
+
+// Includes the CoreMinimal.h header file, which is a central part of the Unreal Engine framework.
+// This header file includes essential core definitions, macros, and types used throughout Unreal Engine.
+// It simplifies includes by aggregating commonly used minimal core components, such as fundamental types,
+// utilities, and standard libraries, reducing the need for multiple individual header file includes.
+#include "CoreMinimal.h"
+#include "GameSession.h"        // Declares the GameSession class, the move list of one board's game.
+#include "SearchLimitPolicy.h"  // Declares the SearchLimits struct the engines search with.
+
+#include <condition_variable>  // Provides std::condition_variable for waiting until an engine is free.
+#include <cstdint>             // Provides std::uint64_t for the order in which requests arrived.
+#include <list>                // Provides std::list for the requests waiting for an engine.
+#include <map>                 // Provides std::map for the games of the boards.
+#include <memory>              // Provides std::shared_ptr for engines that outlive their removal from the pool while in use.
+#include <mutex>               // Provides std::mutex for thread safety.
+#include <string>              // Provides std::string for FEN strings.
+#include <vector>              // Provides std::vector for the engines.
+
+// The pool only hands out references; Stockfish.h (with its platform headers) stays out of this header.
+class Stockfish;
+struct AIRequestToken;
+
+// Order in which waiting requests get an engine.
+enum class AIRequestPriority : std::uint8_t {
+    Interactive,  // The AI's move in a running game; a player is waiting for it.
+    Background    // Hints, post-game analysis and other work nobody is waiting for.
+};
+
+// Pool of independent engine instances, so several boards and background analyses run in parallel.
+// A request leases an engine for its duration. When all engines are busy, requests wait in a queue that serves
+// interactive requests before background work, and requests of the same priority in arrival order.
+// Each board prefers its own engine (board % engine count), so its pondering stays on one engine; if that engine is
+// busy, an idle one is used instead. The game sessions belong to the boards, so any engine can continue a game.
+class LIVINGROOM_API EnginePool {
+public:
+    // Retrieve the single instance of the EnginePool class (singleton pattern)
+    static EnginePool& getInstance();
+
+    // Exclusive use of one engine and a copy of the board's game session; the engine returns to the pool and the
+    // session to the board when the lease is destroyed.
+    class LIVINGROOM_API Lease {
+    public:
+        Lease(Lease&& other) noexcept;
+        ~Lease();
+
+        Stockfish& engine() const;
+
+        // Game session of the board, to be passed to the engine with the request.
+        GameSession& session();
+
+        // False if the request was cancelled while it waited for an engine; such a lease holds no engine.
+        explicit operator bool() const { return leasedEngine != nullptr; }
+
+    private:
+        friend class EnginePool;
+        Lease(EnginePool* pool, size_t slot, std::shared_ptr<Stockfish> leasedEngine, int board, const GameSession& gameSession,
+            std::uint64_t gameGeneration)
+            : pool(pool), slot(slot), leasedEngine(std::move(leasedEngine)), board(board), gameSession(gameSession),
+              gameGeneration(gameGeneration) {}
+
+        EnginePool* pool;
+        size_t slot;
+        std::shared_ptr<Stockfish> leasedEngine;
+        int board;
+        GameSession gameSession;
+        std::uint64_t gameGeneration;  // Generation of the board's game when the lease began.
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+    };
+
+    // Waits until an engine is free and leases it for a request of the given priority and board (0 or higher).
+    // Returns an empty lease if the request's token is cancelled while it waits.
+    Lease acquire(AIRequestPriority priority, int board, const AIRequestToken* token = nullptr);
+
+    // Sets the number of engines (at least 1). Defaults to 2. Additional engines start with their first request;
+    // removed engines are closed as soon as their current request has finished.
+    void setEngineCount(int count);
+
+    // Returns the number of engines.
+    int getEngineCount();
+
+    // Asks the searches of a board to finish early (board -1: all searches). Safe to call from any thread.
+    void stop(int board);
+
+    // Cancels one request, whose token must already be marked as cancelled: a waiting request leaves the queue,
+    // a request holding an engine has its search stopped. Other searches keep running. Safe to call from any thread.
+    void cancel(const AIRequestToken* token);
+
+    // Starts all engines and lets each run a minimal search, so the first requests are fast. Blocks.
+    void prewarm(const int& skillLevel);
+
+    // Marks the beginning of a new game on a board (-1: all boards); the board's next request starts a new move list
+    // and clears the hash table of the engine serving it. The games of the other boards go on.
+    void startNewGame(int board);
+
+    // Records a position that was answered without an engine in the board's game session.
+    void updateGameSession(int board, const std::string& fen);
+
+    // Returns the limits the engines search a request of the given skill level with, under the current budget.
+    SearchLimits limitsFor(const int& skillLevel);
+
+    // Settings forwarded to every engine, including engines added later.
+    void setSearchTimeBudget(const int& milliseconds);
+    void setPondering(const bool& enabled);
+    void setSharedMemoryTransport(const bool& enabled);
+
+    // Closes all engines; they start again with the next request.
+    void closeAll();
+
+    // Closes the Stockfish processes of all engines, e.g. to switch their transport; linked engines keep running.
+    void closeProcessEngines();
+
+private:
+    // One engine and what it is doing.
+    struct Slot {
+        std::shared_ptr<Stockfish> engine;
+        bool busy = false;  // Leased by a request.
+        int board = -1;     // Board of the current lease.
+        const AIRequestToken* request = nullptr;  // Token of the current lease, if it has one.
+    };
+
+    // Game of one board, continued by whichever engine serves the board's next request.
+    struct BoardGame {
+        GameSession session;
+        std::uint64_t generation = 0;  // Increased by startNewGame, so an older lease does not bring back the old game.
+    };
+
+    // A request waiting for an engine.
+    struct Ticket {
+        AIRequestPriority priority;
+        std::uint64_t sequence;  // Arrival order among requests of the same priority.
+        int board;
+        const AIRequestToken* request;
+        size_t slot = SIZE_MAX;  // Assigned engine, SIZE_MAX while waiting.
+    };
+
+    // Hands free engines to the best waiting requests; the caller must hold poolMutex.
+    void dispatch();
+
+    // Returns the engine of a lease to the pool and its game session to the board.
+    void release(Lease& lease);
+
+    // Creates the engine of a slot with the current settings; the caller must hold poolMutex.
+    std::shared_ptr<Stockfish> createEngine(size_t slot);
+
+    // Removes idle engines beyond engineCount and returns them, so they can be closed without holding poolMutex.
+    std::vector<std::shared_ptr<Stockfish>> retireEngines();
+
+    // Returns all engines, so they can be configured without holding poolMutex while one of them is searching.
+    std::vector<std::shared_ptr<Stockfish>> allEngines();
+
+    std::vector<Slot> slots;                   // All engines; slots beyond engineCount are being retired.
+    size_t engineCount = 2;                    // Number of engines requests may use.
+    std::list<Ticket*> waiting;                // Requests waiting for an engine.
+    std::uint64_t nextSequence = 0;            // Sequence number of the next request.
+    std::mutex poolMutex;                      // Guards the slots and the waiting requests.
+    std::condition_variable engineReleased;    // Signalled whenever requests have been assigned an engine.
+    std::map<int, BoardGame> games;            // Game of each board that has made a request.
+
+    // Settings applied to every engine.
+    int searchTimeBudget = -1;  // -1 until setSearchTimeBudget was called.
+    bool ponderingEnabled = true;
+    bool sharedMemoryEnabled = false;
+
+    // Prevent direct instantiation
+    EnginePool();
+
+    // Prevent copy construction and assignment
+    EnginePool(const EnginePool&) = delete;
+    EnginePool& operator=(const EnginePool&) = delete;
+};
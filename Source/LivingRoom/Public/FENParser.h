@@ -6,37 +6,64 @@
 // utilities, and standard libraries, reducing the need for multiple individual header file includes.
 #include "CoreMinimal.h"
 
-#include <string>   // Provides std::string for handling text strings.
-#include <vector>   // Provides std::vector for dynamic arrays, like lists of board rows or moves.
+#include <cstdint>      // Provides std::uint64_t for bitboards.
+#include <string>       // Provides std::string for handling text strings.
+#include <string_view>  // Provides std::string_view for parsing FEN strings without copying them.
+#include <vector>       // Provides std::vector for dynamic arrays, like lists of board rows or moves.
+
+// Piece characters in the order of ChessPosition::pieceBitboards: white pieces first, then black pieces.
+constexpr char CHESS_PIECE_CHARACTERS[] = "PNBRQKpnbrqk";
+
+// Castling rights stored in ChessPosition::castlingRights, in the same order as the legacy castling rights array.
+enum ChessCastlingRight : std::uint8_t {
+    WhiteKingside = 1 << 0,
+    WhiteQueenside = 1 << 1,
+    BlackKingside = 1 << 2,
+    BlackQueenside = 1 << 3
+};
+
+// Compact board state filled by FENParser::parseFEN without any heap allocation.
+// The piece array uses the board index of the legacy board array (0 = a8, 7 = h8, ..., 63 = h1),
+// the bitboards use Stockfish's square numbering (bit 0 = a1, bit 7 = h1, ..., bit 63 = h8).
+struct LIVINGROOM_API ChessPosition {
+    char pieces[64] = {};                 // FEN character of the piece on each square, '.' for an empty square.
+    std::uint64_t pieceBitboards[12] = {}; // One bitboard per piece type, in CHESS_PIECE_CHARACTERS order.
+    std::uint64_t colorBitboards[2] = {};  // All white pieces and all black pieces.
+    bool whitesTurn = true;               // True if white is to move.
+    std::uint8_t castlingRights = 0;      // Combination of ChessCastlingRight flags.
+    std::int8_t enPassantSquare = -1;     // Bitboard square behind a pawn that just moved two squares, or -1.
+    int halfMoveClock = 0;                // Half-moves since the last capture or pawn move.
+    int fullMoveNumber = 1;               // Number of the current full move.
+
+    // Converts between a board index (0 = a8) and a bitboard square (0 = a1); the mapping is its own inverse.
+    static int toBitboardSquare(int boardIndex) { return boardIndex ^ 56; }
+
+    // Returns the bitboard of all occupied squares.
+    std::uint64_t occupied() const { return colorBitboards[0] | colorBitboards[1]; }
+
+    // Returns true if the square with the given board index (0 = a8) is empty.
+    bool isEmpty(int boardIndex) const { return pieces[boardIndex] == '.'; }
+
+    // Returns true if both positions have the same pieces, side to move and castling rights.
+    bool isSamePosition(const ChessPosition& other) const;
+};
 
 class LIVINGROOM_API FENParser {
 public:
+    // Parses a FEN (Forsyth-Edwards Notation) string into a compact position without allocating memory,
+    // cheap enough to be called every frame. Returns false and leaves the starting position in 'position'
+    // if the FEN string is malformed.
+    static bool parseFEN(std::string_view fen, ChessPosition& position);
+
+    // Checks if two FEN strings describe the same position: the same pieces, side to move and castling rights.
+    // The move clocks and the en passant field are ignored, since Stockfish only prints an en passant square
+    // if the capture is actually possible. Returns false if either FEN string is malformed.
+    static bool isSamePosition(std::string_view firstFEN, std::string_view secondFEN);
+
     // Parses a FEN (Forsyth-Edwards Notation) string to set up the board and game details.
     // Updates the board, turn indicator, castling rights, en passant target, half-move clock, and full-move number.
+    // Kept for callers that need the board as strings; prefer the ChessPosition overload.
     void parseFEN(const std::string& fen, std::vector<std::string>& board, bool& whitesTurn,
         std::vector<bool>& castlingRights, std::string& enPassantTarget,
         int& halfMoveClock, int& fullMoveNumber);
-
-    // Extracts legal moves and checks if a draw can be offered based on the FEN string.
-    // Fills the legal moves and draw offer status based on the current FEN.
-    void extractFENDetails(const std::string& fen, std::vector<std::string>& legalMoves,
-        bool& drawOfferable);
-
-private:
-    // Determines which castling moves are possible from the given FEN and updates the list of legal moves.
-    // Checks the board state and whether castling is allowed.
-    void detectPossibleCastlingMoves(const std::string& fen, std::vector<std::string>& legalMoves,
-        std::vector<std::string> board, bool whitesTurn, std::vector<bool> castlingRights);
-
-    // Adds castling moves to the list of legal moves if they are allowed.
-    // Checks if the castling move is valid and if the king is not under attack.
-    void addCastlingOptionIfPossible(std::vector<std::string>& legalMoves,
-        std::vector<std::string>& negativeLegalMoves, const std::vector<std::string>& board,
-        bool whitesTurn, bool castlingAllowed, bool firstCastlingCheck, const std::string& castlingMove);
-
-    // Detects and adds en passant moves to the list of legal moves if applicable.
-    // Checks if the en passant move is possible and updates the list of legal moves accordingly.
-    void detectEnPassant(std::vector<std::string>& legalMoves,
-        const std::vector<std::string>& board,
-        const std::string& enPassantTarget, bool whitesTurn);
 };
@@ -0,0 +1,54 @@
+#pragma once  // Ensures this header file is included only once during compilation.
+
+// Includes the CoreMinimal.h header file, which is a central part of the Unreal Engine framework.
+// This header file includes essential core definitions, macros, and types used throughout Unreal Engine.
+// It simplifies includes by aggregating commonly used minimal core components, such as fundamental types,
+// utilities, and standard libraries, reducing the need for multiple individual header file includes.
+#include "CoreMinimal.h"
+#include "FENParser.h"  // Declares the ChessPosition struct used to find the move between two positions.
+
+#include <string>  // Provides std::string for FEN strings, moves and commands.
+#include <vector>  // Provides std::vector for the move list.
+
+// Tracks the moves of the current game, so the engine receives "position startpos moves ..." (or "position fen
+// <start> moves ...") instead of an unrelated FEN string for every request. The engine then keeps the game's
+// repetition history, and "ucinewgame" (which clears its hash table) is only sent when a new game really starts.
+// The game only ever sends FEN strings; the move between two consecutive positions is reconstructed from the
+// difference of their piece placements.
+class LIVINGROOM_API GameSession {
+public:
+    // Brings the session up to date with the position (FEN string) of a new request.
+    // Appends the move that leads to it, or starts over from this position if it does not follow from the last one.
+    void update(const std::string& fen);
+
+    // Marks the beginning of a new game; the next update starts from its position and sends "ucinewgame".
+    void startNewGame();
+
+    // Returns true if the last update started a new game, so the engine has to receive "ucinewgame" first.
+    bool isNewGame() const;
+
+    // Returns the position command for the current position, optionally followed by further moves
+    // (e.g. the best move and the expected reply when pondering).
+    std::string positionCommand(const std::vector<std::string>& extraMoves = {}) const;
+
+    // Returns the FEN string the move list starts from.
+    const std::string& getStartFEN() const;
+
+    // Returns the moves played since the start position, in UCI notation.
+    const std::vector<std::string>& getMoves() const;
+
+    // Returns true if this session plays on the game of 'earlier': the same start position, starting with its moves.
+    bool continues(const GameSession& earlier) const;
+
+    // Returns the move (UCI notation) that turns one position into the next, or an empty string if the positions
+    // are not exactly one move apart.
+    static std::string findMove(const ChessPosition& before, const ChessPosition& after);
+
+private:
+    std::string startFEN;                // Position the move list starts from.
+    std::vector<std::string> moves;      // Moves played since the start position.
+    ChessPosition currentPosition;       // Position after all moves, for finding the next move.
+    bool hasPosition = false;            // False until the first update.
+    bool newGamePending = true;          // Set by startNewGame, consumed by the next update.
+    bool newGame = false;                // True if the last update started a new game.
+};
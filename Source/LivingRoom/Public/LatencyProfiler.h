@@ -0,0 +1,138 @@
+#pragma once  // Ensures this header file is included only once during compilation.
+
+// Includes the CoreMinimal.h header file, which is a central part of the Unreal Engine framework.
+// This header file includes essential core definitions, macros, and types used throughout Unreal Engine.
+// It simplifies includes by aggregating commonly used minimal core components, such as fundamental types,
+// utilities, and standard libraries, reducing the need for multiple individual header file includes.
+#include "CoreMinimal.h"
+
+#include <atomic>   // Provides std::atomic for switching the profiler on and off from any thread.
+#include <chrono>   // Provides steady_clock for measuring the stages.
+#include <cstdint>  // Provides std::uint32_t for durations in microseconds.
+#include <fstream>  // Provides std::ofstream for the trace file.
+#include <mutex>    // Provides std::mutex for thread safety.
+#include <string>   // Provides std::string for stage names and file paths.
+#include <vector>   // Provides std::vector for the recorded durations.
+
+// Stages of an AI request. Stages nest: a request (Total) contains the cache lookup and the engine request,
+// which contains the engine start, the command writes and the search.
+enum class AILatencyStage : std::uint8_t {
+    Total,          // ChessAIHandler::getChessAIFeedback from start to finish.
+    CacheLookup,    // Looking the position up in the ResponseCache.
+    EngineRequest,  // Stockfish::requestStockfish: the complete round trip to the engine.
+    EngineStart,    // Launching the process or creating the engine, including the UCI handshake.
+    CommandWrite,   // Writing commands to the engine's input pipe.
+    Search,         // Waiting for the engine's answer (board, legal moves and best move).
+    LegalMoves,     // Generating the legal moves with the linked move generator.
+    OutputParsing,  // ChessAIHandler::extractResponse turning the engine's lines into a response.
+    FENProcessing,  // Decoding the board, status flags and moves against the position of the response FEN.
+    Count
+};
+
+#if STATS
+// Builds with stats (Unreal always defines STATS, as 0 in Shipping): every stage is also a cycle stat
+// ("stat ChessAI" in the console), which Unreal Insights shows as CPU events.
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("ChessAI"), STATGROUP_ChessAI, STATCAT_Advanced);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("AI request"), STAT_ChessAI_Total, STATGROUP_ChessAI, LIVINGROOM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cache lookup"), STAT_ChessAI_CacheLookup, STATGROUP_ChessAI, LIVINGROOM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Engine request"), STAT_ChessAI_EngineRequest, STATGROUP_ChessAI, LIVINGROOM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Engine start"), STAT_ChessAI_EngineStart, STATGROUP_ChessAI, LIVINGROOM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Command write"), STAT_ChessAI_CommandWrite, STATGROUP_ChessAI, LIVINGROOM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Search"), STAT_ChessAI_Search, STATGROUP_ChessAI, LIVINGROOM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Legal moves"), STAT_ChessAI_LegalMoves, STATGROUP_ChessAI, LIVINGROOM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Output parsing"), STAT_ChessAI_OutputParsing, STATGROUP_ChessAI, LIVINGROOM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FEN processing"), STAT_ChessAI_FENProcessing, STATGROUP_ChessAI, LIVINGROOM_API);
+
+// Measures the rest of the enclosing scope as the given stage (e.g. SCOPE_AI_LATENCY(Search)).
+#define SCOPE_AI_LATENCY(Stage) \
+    SCOPE_CYCLE_COUNTER(STAT_ChessAI_##Stage); \
+    ScopedLatencyTimer latencyTimer##Stage(AILatencyStage::Stage)
+#else
+// Measures the rest of the enclosing scope as the given stage (e.g. SCOPE_AI_LATENCY(Search)).
+#define SCOPE_AI_LATENCY(Stage) ScopedLatencyTimer latencyTimer##Stage(AILatencyStage::Stage)
+#endif
+
+// Collects the durations of the AI request stages, so their percentiles can be compared between builds and machines.
+// Works without Unreal's stats system: the durations of the last requests are kept in memory for percentiles,
+// and every measurement can be streamed to a CSV trace file for offline analysis of production sessions.
+class LIVINGROOM_API LatencyProfiler {
+public:
+    // Retrieve the single instance of the LatencyProfiler class (singleton pattern)
+    static LatencyProfiler& getInstance();
+
+    // Returns the name of a stage as used in the trace and summary files (e.g. "Search").
+    static const char* stageName(AILatencyStage stage);
+
+    // Finds a stage by its name. Returns false if there is no stage with that name.
+    static bool findStage(const std::string& name, AILatencyStage& stage);
+
+    // Records one duration of a stage in microseconds. Does nothing while the profiler is disabled.
+    void record(AILatencyStage stage, std::uint32_t microseconds);
+
+    // Returns the given percentile (0-100) of the recorded durations of a stage in microseconds, or 0 without samples.
+    std::uint32_t getPercentile(AILatencyStage stage, double percentile);
+
+    // Returns the number of durations of a stage currently kept (at most the last 4096).
+    size_t getSampleCount(AILatencyStage stage);
+
+    // Removes all recorded durations.
+    void reset();
+
+    // Enables or disables recording (enabled by default).
+    void setEnabled(bool enabled);
+
+    // Starts writing every recorded duration to a CSV file ("time_us,stage,duration_us"), replacing an open trace.
+    // Returns false if the file cannot be created.
+    bool startTrace(const std::string& path);
+
+    // Closes the trace file.
+    void stopTrace();
+
+    // Writes count, mean, p50, p95, p99 and maximum of every stage as JSON. Returns false if the file cannot be written.
+    bool writeSummary(const std::string& path);
+
+private:
+    // Number of durations kept per stage; older durations are overwritten.
+    static constexpr size_t SAMPLES_PER_STAGE = 4096;
+
+    // Ring buffer of the most recent durations of one stage.
+    struct StageSamples {
+        std::vector<std::uint32_t> durations;  // Up to SAMPLES_PER_STAGE durations in microseconds.
+        size_t next = 0;                       // Slot the next duration overwrites once the buffer is full.
+    };
+
+    StageSamples stages[static_cast<size_t>(AILatencyStage::Count)];
+
+    std::ofstream traceFile;                                 // Open while a trace runs.
+    std::chrono::steady_clock::time_point traceStart;        // Time stamps in the trace are relative to this.
+    std::atomic<bool> enabled{ true };                       // Set by setEnabled.
+    std::mutex profilerMutex;                                // Guards the samples and the trace file.
+
+    // Prevent direct instantiation
+    LatencyProfiler() {}
+
+    // Prevent copy construction and assignment
+    LatencyProfiler(const LatencyProfiler&) = delete;
+    LatencyProfiler& operator=(const LatencyProfiler&) = delete;
+};
+
+// Records the time between its construction and destruction as one duration of a stage.
+class ScopedLatencyTimer {
+public:
+    explicit ScopedLatencyTimer(AILatencyStage stage)
+        : stage(stage), start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedLatencyTimer() {
+        const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        LatencyProfiler::getInstance().record(stage, static_cast<std::uint32_t>(duration.count()));
+    }
+
+private:
+    AILatencyStage stage;
+    std::chrono::steady_clock::time_point start;
+
+    ScopedLatencyTimer(const ScopedLatencyTimer&) = delete;
+    ScopedLatencyTimer& operator=(const ScopedLatencyTimer&) = delete;
+};
@@ -0,0 +1,105 @@
+#pragma once  // Ensures this header file is included only once during compilation.
+
+// Includes the CoreMinimal.h header file, which is a central part of the Unreal Engine framework.
+// This header file includes essential core definitions, macros, and types used throughout Unreal Engine.
+// It simplifies includes by aggregating commonly used minimal core components, such as fundamental types,
+// utilities, and standard libraries, reducing the need for multiple individual header file includes.
+#include "CoreMinimal.h"
+#include "ChessAIHandler.h"  // Declares the StockfishResponse struct stored in the cache.
+#include "FENParser.h"       // Declares the ChessPosition struct the position hash is computed from.
+#include "SearchLimitPolicy.h" // Declares the SearchLimits struct, part of the key of a cached response.
+
+#include <cstdint>        // Provides std::uint64_t for position hashes.
+#include <list>           // Provides std::list for keeping the entries in least-recently-used order.
+#include <mutex>          // Provides std::mutex for thread safety.
+#include <string>         // Provides std::string for FEN strings and file paths.
+#include <unordered_map>  // Provides std::unordered_map for finding entries by key.
+
+// Bounded least-recently-used cache of engine responses, keyed by a Zobrist hash of the position, the skill level
+// and the search limits, so a response searched within another time budget is never returned.
+// Replays, undo/redo and repeated openings send the same position again and again; those requests are answered
+// from the cache instead of running another engine search. The cache is shared by all ChessAIHandler instances.
+class LIVINGROOM_API ResponseCache {
+public:
+    // Retrieve the single instance of the ResponseCache class (singleton pattern)
+    static ResponseCache& getInstance();
+
+    // Computes the Zobrist hash of a position: pieces, side to move, castling rights, en passant square
+    // and the move clocks (the corrected FEN of a cached response contains them).
+    static std::uint64_t hashPosition(const ChessPosition& position);
+
+    // Copies the cached response for a position hash, skill level and search limits into 'response'.
+    // Returns false (and counts a miss) if the position is not cached.
+    bool find(std::uint64_t positionHash, int skillLevel, const SearchLimits& limits, StockfishResponse& response);
+
+    // Stores a response, evicting the least recently used entry if the cache is full.
+    void insert(std::uint64_t positionHash, int skillLevel, const SearchLimits& limits, const StockfishResponse& response);
+
+    // Sets the maximum number of cached responses (at least 1); evicts old entries if necessary.
+    // Defaults to 1024.
+    void setCapacity(size_t maximumEntries);
+
+    // Removes all entries and resets the hit and miss counters.
+    void clear();
+
+    // Number of requests answered from the cache.
+    std::uint64_t getHits();
+
+    // Number of requests that had to be sent to the engine.
+    std::uint64_t getMisses();
+
+    // Number of cached responses.
+    size_t getSize();
+
+    // Writes all entries to a binary file, so they survive a restart. Returns false if the file cannot be written.
+    bool saveToFile(const std::string& path);
+
+    // Adds the entries of a file written by saveToFile. Returns false if the file is missing or invalid.
+    bool loadFromFile(const std::string& path);
+
+private:
+    // Position hash, skill level and search limits identifying a cached response.
+    struct CacheKey {
+        std::uint64_t positionHash;
+        int skillLevel;
+        int moveTime;
+        std::uint64_t nodes;
+
+        bool operator==(const CacheKey& other) const {
+            return positionHash == other.positionHash && skillLevel == other.skillLevel
+                && moveTime == other.moveTime && nodes == other.nodes;
+        }
+    };
+
+    // Hash function for CacheKey; the position hash is already uniformly distributed.
+    // The node limit follows from the skill level, so only the time limit is mixed in besides it.
+    struct CacheKeyHash {
+        size_t operator()(const CacheKey& key) const {
+            const std::uint64_t settings = (static_cast<std::uint64_t>(key.skillLevel) << 32) | static_cast<std::uint32_t>(key.moveTime);
+            return static_cast<size_t>(key.positionHash ^ (settings * 0x9E3779B97F4A7C15ULL));
+        }
+    };
+
+    // Stores a response; the caller must hold cacheMutex.
+    void insertLocked(const CacheKey& key, const StockfishResponse& response);
+
+    // Entries in least-recently-used order (front = most recently used).
+    std::list<std::pair<CacheKey, StockfishResponse>> entries;
+
+    // Finds the list entry of a key in constant time.
+    std::unordered_map<CacheKey, std::list<std::pair<CacheKey, StockfishResponse>>::iterator, CacheKeyHash> index;
+
+    // Guards the entries and counters; requests may come from worker threads as well as the game thread.
+    std::mutex cacheMutex;
+
+    size_t capacity = 1024;   // Maximum number of cached responses.
+    std::uint64_t hits = 0;   // Requests answered from the cache.
+    std::uint64_t misses = 0; // Requests that were not cached.
+
+    // Prevent direct instantiation
+    ResponseCache() {}
+
+    // Prevent copy construction and assignment
+    ResponseCache(const ResponseCache&) = delete;
+    ResponseCache& operator=(const ResponseCache&) = delete;
+};
@@ -0,0 +1,39 @@
+#pragma once  // Ensures this header file is included only once during compilation.
+
+// Includes the CoreMinimal.h header file, which is a central part of the Unreal Engine framework.
+// This header file includes essential core definitions, macros, and types used throughout Unreal Engine.
+// It simplifies includes by aggregating commonly used minimal core components, such as fundamental types,
+// utilities, and standard libraries, reducing the need for multiple individual header file includes.
+#include "CoreMinimal.h"
+
+#include <atomic>   // Provides std::atomic for a budget that may be changed from any thread.
+#include <cstdint>  // Provides std::uint64_t for node counts.
+#include <string>   // Provides std::string for the arguments of the "go" command.
+
+// Limits of a single search, in the units of Stockfish's "go" command and Search::LimitsType.
+struct SearchLimits {
+    int moveTime = 0;         // Wall-clock limit of the search in milliseconds ("go movetime").
+    std::uint64_t nodes = 0;  // Maximum number of nodes to search ("go nodes").
+
+    // Returns the limits as arguments of the "go" command (e.g. "movetime 500 nodes 320000").
+    std::string toGoArguments() const;
+};
+
+// Turns a skill level and a wall-clock budget into search limits.
+// The node limit grows with the skill level and keeps the playing strength the same on every machine; the time
+// limit caps the search on slow machines, so a reply never takes much longer than the budget. Depth is not limited,
+// because the time a fixed depth takes varies by orders of magnitude between quiet and tactical positions.
+class LIVINGROOM_API SearchLimitPolicy {
+public:
+    // Returns the limits for a search with the given skill level (0-20) within the current budget.
+    SearchLimits limitsFor(const int& skillLevel) const;
+
+    // Sets the wall-clock budget of a search in milliseconds (at least 10). Defaults to one second.
+    void setTimeBudget(const int& milliseconds);
+
+    // Returns the wall-clock budget of a search in milliseconds.
+    int getTimeBudget() const;
+
+private:
+    std::atomic<int> timeBudget{ 1000 };  // Budget in milliseconds.
+};
@@ -0,0 +1,113 @@
+#pragma once  // Ensures this header file is included only once during compilation.
+
+// Includes the CoreMinimal.h header file, which is a central part of the Unreal Engine framework.
+// This header file includes essential core definitions, macros, and types used throughout Unreal Engine.
+// It simplifies includes by aggregating commonly used minimal core components, such as fundamental types,
+// utilities, and standard libraries, reducing the need for multiple individual header file includes.
+#include "CoreMinimal.h"
+
+#include <algorithm>  // Provides std::min for the wrap-around copies.
+#include <atomic>     // Provides std::atomic for the ring positions shared with the Stockfish process.
+#include <cstddef>    // Provides size_t for the ring capacities.
+#include <cstdint>    // Provides fixed-width integers for the shared memory layout.
+#include <cstring>    // Provides std::memcpy for copying records in and out of the rings.
+#include <mutex>      // Provides std::mutex for writers on different threads (requests and stop calls).
+#include <string>     // Provides std::string for command and output lines.
+
+#ifdef _WIN32
+#include <windows.h>  // Provides CreateFileMapping for the shared memory segment.
+#endif
+
+// Shared memory transport to a Stockfish process built with src/shmchannel.cpp.
+// Commands and output lines travel through two lock-free single-producer single-consumer ring buffers in a
+// shm_open segment (a named file mapping on Windows) instead of the stdin and stdout pipes. Each record is one
+// complete line, so neither side splits a byte stream, and no system call is made while both sides are busy.
+// An engine that has been idle for a while blocks until writeLines signals new commands (a futex on Linux, a named
+// event on Windows). The output records are the engine's UCI lines, parsed like the lines from the pipe.
+// The segment layout mirrors Stockfish::ShmChannel in src/shmchannel.h and must change together with it.
+class LIVINGROOM_API SharedMemoryChannel {
+public:
+    SharedMemoryChannel() {}
+    ~SharedMemoryChannel();
+
+    // Creates a zero-filled segment for the engine of a pool slot. Returns false if shared memory is unavailable.
+    bool create(int instanceIndex);
+
+    // Returns true while a segment is mapped.
+    bool isOpen() const;
+
+    // Returns the environment entry that tells the Stockfish process which segment to use ("STOCKFISH_SHM=<name>").
+    std::string environmentEntry() const;
+
+    // Returns true once the Stockfish process has mapped the segment and reads its commands from it.
+    bool engineAttached() const;
+
+    // Switches communication to the segment after the engine attached. Removes the segment's name, so the memory
+    // is released with the last mapping even if the game crashes.
+    void activate();
+
+    // Returns true while commands and output go through the segment.
+    bool isActive() const;
+
+    // Writes each line of 'text' as one command record. Waits at most 'timeout' milliseconds for room in the ring.
+    // Safe to call from any thread. Returns false if the channel is closed or the engine stopped reading.
+    bool writeLines(const std::string& text, const int& timeout);
+
+    // Takes the next output line of the engine. Returns false if there is none yet. Only one thread may read.
+    bool readLine(std::string& line);
+
+    // Unmaps the segment and removes its name.
+    void close();
+
+    // Waits a little longer on every call: spins first for microsecond latency while the engine is busy, then
+    // yields, then sleeps. The count saturates, so waiting any length of time never starts spinning again.
+    // Returns true if it slept, which is a good moment to check that the engine still runs.
+    static bool backoff(int& rounds);
+
+private:
+    // Records are a 32-bit length followed by the bytes of the line, wrapping around the end of the buffer.
+    // Head and tail only grow; their difference is the fill level.
+    template<size_t Capacity>
+    struct Ring {
+        alignas(64) std::atomic<std::uint64_t> head;  // Written by the producer only.
+        alignas(64) std::atomic<std::uint64_t> tail;  // Written by the consumer only.
+        alignas(64) char data[Capacity];
+
+        bool tryPush(const char* line, size_t size);
+        bool tryPop(std::string& line);
+        void copyIn(std::uint64_t position, const void* source, size_t size);
+        void copyOut(std::uint64_t position, void* destination, size_t size) const;
+    };
+
+    // Layout of the segment, identical to Stockfish::ShmChannel::Segment.
+    struct Segment {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint64_t hostProcess;                 // Process id of the game; the engine exits when it is gone.
+        std::atomic<std::uint32_t> attached;       // Set by the engine.
+        std::atomic<std::uint32_t> commandSignal;  // Increased after every write; the word an idle engine waits on.
+        std::atomic<std::uint32_t> engineWaiting;  // Set by the engine while it waits on commandSignal.
+        Ring<64 * 1024> commands;                  // Game to engine.
+        Ring<1024 * 1024> output;                  // Engine to game.
+    };
+
+    static constexpr std::uint32_t MAGIC = 0x31434653;  // "SFC1"
+    static constexpr std::uint32_t VERSION = 2;
+
+    Segment* segment = nullptr;         // Mapped segment, nullptr while closed.
+    std::string name;                   // Name of the segment while it can still be opened by name.
+    std::atomic<bool> active{ false };  // Set by activate.
+    std::mutex writeMutex;              // Keeps the command ring single-producer and guards the mapping against close.
+
+#ifdef _WIN32
+    HANDLE mappingHandle = NULL;        // File mapping backing the segment.
+    HANDLE signalEvent = NULL;          // Event the idle engine waits on, named after the segment with "-signal".
+#endif
+
+    // Tells an idle engine that new commands are in the ring; the caller must hold writeMutex.
+    void signalEngine();
+
+    // Prevent copy construction and assignment
+    SharedMemoryChannel(const SharedMemoryChannel&) = delete;
+    SharedMemoryChannel& operator=(const SharedMemoryChannel&) = delete;
+};
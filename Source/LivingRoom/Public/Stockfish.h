@@ -5,7 +5,14 @@
 // It simplifies includes by aggregating commonly used minimal core components, such as fundamental types,
 // utilities, and standard libraries, reducing the need for multiple individual header file includes.
 #include "CoreMinimal.h"
-
+#include "AIRequestToken.h"   // Declares the AIRequestToken struct identifying the request a search belongs to.
+#include "StockfishEngine.h"  // Declares the StockfishEngine class, the in-process backend linked from the Stockfish library.
+#include "GameSession.h"      // Declares the GameSession class, which turns the requested FEN strings into a move list.
+#include "SearchLimitPolicy.h" // Declares the SearchLimitPolicy class, which turns skill levels into time and node limits.
+#include "SharedMemoryChannel.h" // Declares the SharedMemoryChannel class, the optional shared memory transport to the process.
+
+#include <atomic>      // Provides std::atomic for the pondering switch, which may be flipped from any thread.
+#include <chrono>      // Provides steady_clock for the deadline of a read.
 #include <iostream>    // Provides input and output functionalities (e.g., std::cout for logging).
 #include <sstream>     // Provides std::stringstream for parsing and processing strings.
 #include <string>      // Provides std::string for handling text.
@@ -21,24 +28,76 @@
 #include <fcntl.h>      // Provides file control options (e.g., non-blocking mode for pipes).
 #endif
 
+// One engine: the linked in-process engine or a Stockfish process, with its own pondering. The game session comes
+// with each request, since the EnginePool keeps one per board and any engine may serve any board.
+// Instances are owned by the EnginePool; each one has an index that keeps its single-instance lock apart from
+// the locks of the other engines in the pool.
 class LIVINGROOM_API Stockfish {
 public:
-    // Retrieve the single instance of the Stockfish class (singleton pattern)
-    static Stockfish& getInstance();
+    explicit Stockfish(int instanceIndex);
+
+    // Stops the search and closes the engine.
+    ~Stockfish();
 
     // Requests Stockfish to analyze a position based on skill level and FEN string.
+    // The position is first added to the game session, whose moves are sent instead of the FEN string.
     // Returns the results from Stockfish as a vector of strings.
-    std::vector<std::string> requestStockfish(const int& skillLevel, const std::string& fen);
+    // The token lets stopRequest find this request's search; a request cancelled before its search started
+    // returns no lines.
+    std::vector<std::string> requestStockfish(const int& skillLevel, const std::string& fen, GameSession& session, AIRequestToken* token = nullptr);
+
+    // Starts the engine with the specified skill level, completes the handshake and runs a minimal search, so the
+    // first requestStockfish call is as fast as every later one. Blocks while it runs; call it from a worker thread.
+    void prewarmStockfish(const int& skillLevel);
+
+    // Fills 'moves' with the legal moves of a position (FEN string) in Stockfish's packed 16-bit encoding.
+    // Returns false if the in-process engine is not linked; the moves then have to be taken from the
+    // "go perft 1" output of requestStockfish instead.
+    static bool requestLegalMoves(const std::string& fen, std::vector<uint16_t>& moves);
+
+    // Asks a running search to finish as soon as possible, so a pending requestStockfish call returns early.
+    // Safe to call from any thread; does nothing if no search is running.
+    void stopStockfish();
+
+    // Asks the search of one request to finish as soon as possible. Unlike stopStockfish, it leaves the search of
+    // any other request and the ponder search alone. Safe to call from any thread.
+    void stopRequest(const AIRequestToken* token);
+
+    // Sets how long a request waits for the engine's answer (e.g. "bestmove") before the watchdog steps in.
+    // Defaults to 10 seconds.
+    void setResponseTimeout(const int& milliseconds);
+
+    // Sets how long the watchdog waits for "readyok" after a missed deadline before it declares the engine stuck,
+    // kills it and starts a new one. Defaults to 500 milliseconds.
+    void setHeartbeatTimeout(const int& milliseconds);
+
+    // Sets the wall-clock budget of a search in milliseconds (defaults to one second). The skill level decides how
+    // much of the budget a search may use; the response timeout is raised if it is shorter than the budget.
+    void setSearchTimeBudget(const int& milliseconds);
+
+    // Enables or disables pondering (enabled by default): after each request the engine keeps searching the
+    // position after its best move and the reply it expects, using the player's thinking time. A request for
+    // that position is answered with "ponderhit", any other position stops the ponder search first.
+    void setPondering(const bool& enabled);
+
+    // Enables or disables the shared memory transport (disabled by default): commands and output lines of the
+    // Stockfish process travel through ring buffers in shared memory instead of pipes (see SharedMemoryChannel).
+    // Takes effect when the process starts next; an executable without support for it keeps using the pipes.
+    void setSharedMemoryTransport(const bool& enabled);
 
     // Closes the handles to the pipes and the Stockfish process.
     // This is called when Stockfish is no longer needed.
     void closeStockfish();
 
+    // Closes only the Stockfish process, which starts again with the next request (e.g. with a new transport).
+    // The in-process engine keeps its hash table, network and threads.
+    void closeStockfishProcess();
+
     private:
     #ifdef _WIN32
         SECURITY_ATTRIBUTES saAttr;    // Security attributes for process and pipe creation.
         STARTUPINFO si;                // STARTUPINFO structure for process creation.
-        PROCESS_INFORMATION pi;        // PROCESS_INFORMATION structure for process creation.
+        PROCESS_INFORMATION pi = {};   // PROCESS_INFORMATION structure for process creation.
         HANDLE hStdinRead = NULL;      // Handle for reading from the standard input pipe.
         HANDLE hStdinWrite = NULL;     // Handle for writing to the standard input pipe.
         HANDLE hStdoutRead = NULL;     // Handle for reading from the standard output pipe.
@@ -53,7 +112,7 @@ public:
         int stdinPipe[2];   // Pipe for writing commands to Stockfish's standard input.
         int stdoutPipe[2];  // Pipe for reading Stockfish's standard output.
         int stderrPipe[2]; // Pipe for Stockfish's standard errors output.
-        pid_t stockfishPid;  // Process ID of the Stockfish engine.
+        pid_t stockfishPid = -1;  // Process ID of the Stockfish engine.
         pthread_mutex_t stockfishMutex = PTHREAD_MUTEX_INITIALIZER;  // POSIX mutex
         int lockFileDescriptor = -1;   // File descriptor for lock (macOS/Linux)
         int hStdinRead = 0;      // Handle for reading from the standard input pipe.
@@ -63,30 +122,127 @@ public:
         int hStderrRead = 0;     // Handle for reading from the standard error pipe.
     #endif
 
+    // Serializes requests, which may now come from worker threads as well as the game thread.
+    std::mutex requestMutex;
+
+    // Guards searchRequest and ponderStopped, and makes checking a request's token and sending its "go" or
+    // "ponderhit" one step, so a "stop" from stopRequest can never arrive before the search it is meant for.
+    std::mutex searchMutex;
+
+    // Request whose search the process is running, nullptr while idle or pondering.
+    AIRequestToken* searchRequest = nullptr;
+
+    // Set by stopStockfish while no request's search runs, so a stopped ponder search is never taken for an answer.
+    bool ponderStopped = false;
+
+    // In-process engine, used instead of the executable whenever the Stockfish library is linked.
+    StockfishEngine inProcessEngine;
+
+    // Waits until a process started with the shared memory transport has attached to the segment. An engine that
+    // prints to the pipe first does not support the transport; the channel is closed and the pipes are used.
+    void connectChannel();
+
     // Starts the Stockfish engine with the specified skill level.
-    // Sets up pipes for communication and launches the Stockfish process.
+    // Sets up pipes for communication, launches the Stockfish process and performs the UCI handshake once.
+    // If the engine is already running, only a changed skill level is sent.
     void startStockfish(const int& skillLevel);
 
     // Sends a command to Stockfish through the standard input pipe.
-    // Ensures the command ends with a newline and handles errors.
+    // Ensures the command ends with a newline and handles errors. Does not wait for Stockfish to process it.
     void sendStockfishCommand(const std::string& str);
 
-    // Retrieves the results from Stockfish after sending a command.
-    // This function collects output from Stockfish for various commands.
-    std::vector<std::string> getStockfishResults(const std::string& command);
+    // Sends a complete request (position, queries and search) in one write and collects
+    // all output up to the "bestmove" line in one read, supervised by the watchdog (see readSupervisedOutput).
+    // Nothing is sent if the request's token has been cancelled.
+    std::vector<std::string> getStockfishResults(const std::string& command, AIRequestToken* token = nullptr);
+
+    // Reads output from Stockfish through the standard output pipe until a line starting with the terminator
+    // (e.g. "bestmove", "readyok") arrives, the timeout (in milliseconds) expires or the pipe is closed.
+    // Collects and returns the complete lines as a vector of strings.
+    // If an earlier read timed out, the output up to its terminator is skipped first (within the same timeout),
+    // unless the same terminator is requested again; then the lines continue where the earlier read stopped.
+    std::vector<std::string> readStockfishOutput(const std::string& terminator, const int& timeout);
+
+    // Appends the lines read until one starts with the terminator. Returns false if the deadline passed or the
+    // output was closed before the terminator arrived.
+    bool readStockfishLines(const std::string& terminator, const std::chrono::steady_clock::time_point& deadline, std::vector<std::string>& lines);
+
+    // Watchdog around readStockfishOutput with the response timeout. If the deadline passes, the engine gets
+    // "stop" and a heartbeat "isready"; a live engine then answers with its best move so far. A dead process
+    // (waitpid) or a missing heartbeat gets the engine killed. Returns true if the terminator arrived.
+    bool readSupervisedOutput(const std::string& terminator, std::vector<std::string>& lines);
+
+    // Returns true if the Stockfish process has been started and has not exited.
+    bool isStockfishAlive();
+
+    // Kills the Stockfish process, closes the pipes and releases the single-instance lock, so the next
+    // startStockfish call launches a fresh engine.
+    void terminateStockfish();
+
+    // Releases the lock taken by isStockfishAlreadyRunning.
+    void releaseInstanceLock();
+
+    // Resolves a running ponder search for a new request. Returns true and fills 'response' if the ponder search
+    // answers the request ("ponderhit"), otherwise stops it and drains its "bestmove" line.
+    // Only a request whose game session continues the pondered game can be answered.
+    bool resolvePondering(const int& skillLevel, const std::string& fen, const GameSession& session, const SearchLimits& limits,
+        std::vector<std::string>& response, AIRequestToken* token);
+
+    // Starts "go ponder" on the position after the best move and the expected reply of a finished request.
+    void startPondering(const GameSession& session, const int& skillLevel, const SearchLimits& limits, const std::vector<std::string>& response);
+
+    // Turns the skill level of a request into time and node limits.
+    SearchLimitPolicy limitPolicy;
+
+    // Set by setPondering.
+    std::atomic<bool> ponderingEnabled{ true };
+
+    // Set by setSharedMemoryTransport.
+    std::atomic<bool> sharedMemoryEnabled{ false };
+
+    // Shared memory segment of the running process, active if the process attached to it.
+    SharedMemoryChannel channel;
+
+    // True while a "go ponder" search runs in the Stockfish process.
+    bool pondering = false;
+
+    // Skill level, limits and game session of the request the ponder search continues.
+    int ponderSkillLevel = -1;
+    SearchLimits ponderLimits;
+    GameSession ponderGame;
+
+    // Position being pondered (after the best move and the expected reply) and its "d" and "go perft 1" lines.
+    std::string ponderFEN;
+    std::vector<std::string> ponderBoard;
+
+    // Position right after the best move (the root of the ponder search) and the answer for it: its "d" and
+    // "go perft 1" lines and the expected reply as best move.
+    std::string ponderRootFEN;
+    std::vector<std::string> ponderRootResponse;
+
+    // Output received from Stockfish that does not yet form a complete line.
+    std::string outputBuffer;
+
+    // Terminator of the last read that timed out, empty if the output is in step with the commands sent.
+    std::string missedTerminator;
+
+    // Maximum time in milliseconds to wait for the answer to a command.
+    int responseTimeout = 10000;
+
+    // Maximum time in milliseconds a live engine needs to answer "stop" and "isready".
+    int heartbeatTimeout = 500;
 
-    // Reads output from Stockfish through the standard output pipe.
-    // Collects and returns the output as a vector of strings.
-    std::vector<std::string> readStockfishOutput();
+    // Skill level the running engine was configured with.
+    int currentSkillLevel = -1;
 
-    // Prevent direct instantiation
-    Stockfish() {}
+    // Index of this engine in the pool.
+    int instanceIndex = 0;
 
     // Prevent copy construction and assignment
     Stockfish(const Stockfish&) = delete;
     Stockfish& operator=(const Stockfish&) = delete;
 
-    // Function to check if Stockfish is already running
+    // Function to check if the Stockfish process of this pool slot is already running
     bool isStockfishAlreadyRunning();
 };
 
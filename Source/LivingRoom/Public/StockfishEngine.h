@@ -0,0 +1,94 @@
+#pragma once  // Ensures this header file is included only once during compilation.
+
+// Includes the CoreMinimal.h header file, which is a central part of the Unreal Engine framework.
+// This header file includes essential core definitions, macros, and types used throughout Unreal Engine.
+// It simplifies includes by aggregating commonly used minimal core components, such as fundamental types,
+// utilities, and standard libraries, reducing the need for multiple individual header file includes.
+#include "CoreMinimal.h"
+#include "AIRequestToken.h"     // Declares the AIRequestToken struct identifying the request a search belongs to.
+#include "GameSession.h"        // Declares the GameSession class holding the start position and moves of the game.
+#include "SearchLimitPolicy.h"  // Declares the SearchLimits struct with the time and node limits of a search.
+
+#include <atomic>      // Provides std::atomic for the pondering switch, which may be flipped from any thread.
+#include <cstdint>     // Provides std::uint16_t for packed moves.
+#include <memory>      // Provides std::unique_ptr for owning the hidden engine implementation.
+#include <mutex>       // Provides std::mutex for guarding the engine against concurrent access.
+#include <string>      // Provides std::string for handling text.
+#include <vector>      // Provides std::vector for handling dynamic arrays.
+
+// In-process Stockfish backend.
+// Links the vendored Stockfish::Engine directly into the LivingRoom module and drives it through its C++ API
+// (set_position, go and the bestmove/update callbacks) instead of a child process, pipes and sleeps.
+// The Stockfish engine headers are only included in StockfishEngine.cpp, because their "Stockfish" namespace
+// would clash with the Stockfish wrapper class.
+class LIVINGROOM_API StockfishEngine {
+public:
+    StockfishEngine();
+    ~StockfishEngine();
+
+    // Returns true if the module was built against the Stockfish static library (WITH_STOCKFISH_INPROCESS).
+    static bool isAvailable();
+
+    // Creates the engine on first use and configures it with the specified skill level.
+    void start(const int& skillLevel);
+
+    // Creates and configures the engine and runs a minimal search, so the network, the hash table and the search
+    // threads are ready before the first real request. Does nothing while a ponder search runs.
+    void prewarm(const int& skillLevel);
+
+    // Analyzes the current position of a game session (whose last update was the FEN string 'fen') with the given
+    // skill level, searching within the given limits. The engine receives the session's start position and moves,
+    // so it knows the game's repetition history; its hash table is only cleared when the session starts a new game.
+    // Returns the same lines the Stockfish executable prints for "d" and "go movetime", so the results can be
+    // parsed exactly like the output of the process backend. Legal moves come from legalMoves() instead.
+    // If pondering is enabled, the engine keeps searching the expected reply afterwards (see setPondering).
+    // A request whose token was cancelled before its search started returns no lines.
+    std::vector<std::string> request(const int& skillLevel, const std::string& fen, const GameSession& session, const SearchLimits& limits,
+        AIRequestToken* token = nullptr);
+
+    // Enables or disables pondering (enabled by default). After each search the engine then ponders the position
+    // after its best move and the reply it expects; a request for that position turns the ponder search into
+    // the real search ("ponderhit"), any other request stops it first. A request for the position right after
+    // the engine's move is answered from the ponder search's root without interrupting it.
+    void setPondering(bool enabled);
+
+    // Generates the legal moves of a position (FEN string) with Stockfish's MoveList<LEGAL>.
+    // Returns the raw 16-bit Stockfish moves (see ChessMove), without any text formatting.
+    static std::vector<std::uint16_t> legalMoves(const std::string& fen);
+
+    // Asks the running search to finish as soon as possible. Safe to call from any thread.
+    void stop();
+
+    // Asks the search of one request to finish as soon as possible; does nothing if another request's search
+    // or a ponder search is running. Safe to call from any thread.
+    void stopRequest(const AIRequestToken* token);
+
+    // Stops any running search and releases the engine.
+    void close();
+
+private:
+    // Hides the Stockfish::Engine instance and the search results collected by its callbacks.
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+
+    // Starts pondering on the position after the last best move and the expected reply, if there is one.
+    void startPondering(const GameSession& session, const int& skillLevel, const SearchLimits& limits);
+
+    // Resolves a running ponder search for a new request. Returns true and fills 'response' if the ponder search
+    // could answer the request, otherwise stops it, so a normal search can start.
+    bool resolvePondering(const int& skillLevel, const std::string& fen, const GameSession& session, const SearchLimits& limits,
+        std::vector<std::string>& response, AIRequestToken* token);
+
+    // Set by setPondering.
+    std::atomic<bool> ponderingEnabled{ true };
+
+    // Guards the creation and release of the engine and its pondering flag against concurrent stop() calls.
+    std::mutex engineMutex;
+
+    // Request whose search is running, nullptr for ponder searches; guarded by engineMutex.
+    AIRequestToken* searchRequest = nullptr;
+
+    // Prevent copy construction and assignment
+    StockfishEngine(const StockfishEngine&) = delete;
+    StockfishEngine& operator=(const StockfishEngine&) = delete;
+};
@@ -43,9 +43,10 @@ enum Square : int;
 
 class Engine {
    public:
-    using InfoShort = Search::InfoShort;
-    using InfoFull  = Search::InfoFull;
-    using InfoIter  = Search::InfoIteration;
+    using InfoShort   = Search::InfoShort;
+    using InfoFull    = Search::InfoFull;
+    using InfoIter    = Search::InfoIteration;
+    using BatchResult = Search::BatchResult;
 
     Engine(std::string path = "");
 
@@ -69,10 +70,23 @@ class Engine {
     // set a new position, moves are in UCI format
     void set_position(const std::string& fen, const std::vector<std::string>& moves);
 
+    // blocking call to search many positions, each on its own thread with the
+    // given limits (depth, nodes or movetime; without one a position is searched
+    // until stop()). Every result is passed to the callback as soon as it is ready.
+    void analyze_batch(const std::vector<std::string>&           fens,
+                       const Search::LimitsType&                 limits,
+                       std::function<void(const BatchResult&)>&& onResult);
+
+    // blocking calls to write the hash table to a file and to restore it,
+    // the table must have the size it had when saved. Return a message for the GUI
+    std::string save_tt(const std::string& file);
+    std::string load_tt(const std::string& file);
+
     // modifiers
 
-    void set_numa_config_from_option(const std::string& o);
-    void resize_threads();
+    // both return the message of reloading the HashFile snapshot, if any
+    std::optional<std::string> set_numa_config_from_option(const std::string& o);
+    std::optional<std::string> resize_threads();
     void set_tt_size(size_t mb);
     void set_ponderhit(bool);
     void search_clear();
@@ -120,6 +134,8 @@ class Engine {
     LazyNumaReplicated<Eval::NNUE::Networks> networks;
 
     Search::SearchManager::UpdateContext updateContext;
+
+    std::optional<std::string> load_hash_file(bool afterResize = false);
 };
 
 }  // namespace Stockfish
@@ -31,6 +31,7 @@
 #include <list>
 #include <ratio>
 #include <string>
+#include <thread>
 #include <utility>
 
 #include "evaluate.h"
@@ -133,6 +134,12 @@ void Search::Worker::ensure_network_replicated() {
     (void) (networks[numaAccessToken]);
 }
 
+// The search stops when the pool is stopped, or when a position of a batch
+// analysis has reached its own limits
+bool Search::Worker::stopped() const {
+    return threads.stop.load(std::memory_order_relaxed) || batchStop;
+}
+
 void Search::Worker::start_searching() {
 
     // Non-main threads go directly to iterative_deepening()
@@ -162,9 +169,11 @@ void Search::Worker::start_searching() {
     // threads.stop. However, if we are pondering or in an infinite search,
     // the UCI protocol states that we shouldn't print the best move before the
     // GUI sends a "stop" or "ponderhit" command. We therefore simply wait here
-    // until the GUI sends one of those commands.
-    while (!threads.stop && (main_manager()->ponder || limits.infinite))
-    {}  // Busy wait for a stop or a ponder reset
+    // until the GUI sends one of those commands. A ponder search that reached
+    // its node limit has raised threads.stop already and waits as well; both
+    // commands reset the ponder flag. Sleep meanwhile, the player may take minutes.
+    while (main_manager()->ponder || (limits.infinite && !threads.stop))
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
 
     // Stop the threads if not already stopped (also raise the stop if
     // "ponderhit" just reset threads.ponder)
@@ -204,12 +213,68 @@ void Search::Worker::start_searching() {
     main_manager()->updates.onBestmove(bestmove, ponder);
 }
 
+// Searches one position independently of the other threads, which may be busy
+// with positions of their own. The worker stops at the limits of the position
+// (depth, nodes or movetime) or when the pool is stopped, and returns its best
+// line like the main thread would report it.
+Search::BatchResult
+Search::Worker::analyze_position(const std::string& fen, bool isChess960, const LimitsType& l) {
+
+    limits           = l;
+    limits.startTime = now();
+    nodes = tbHits = nmpMinPly = bestMoveChanges = 0;
+    rootDepth = completedDepth = 0;
+    rootPos.set(fen, isChess960, &rootState);
+
+    rootMoves.clear();
+    for (const auto& m : MoveList<LEGAL>(rootPos))
+        rootMoves.emplace_back(m);
+
+    BatchResult result{};
+
+    if (rootMoves.empty())
+    {
+        result.bestmove = "(none)";
+        result.score    = {rootPos.checkers() ? -VALUE_MATE : VALUE_DRAW, rootPos};
+        return result;
+    }
+
+    tbConfig = Tablebases::rank_root_moves(options, rootPos, rootMoves);
+
+    batchSearch   = true;
+    batchStop     = false;
+    batchCallsCnt = 0;
+    iterative_deepening();
+    batchSearch = false;
+
+    RootMove& best    = rootMoves[0];
+    bool      updated = best.score != -VALUE_INFINITE;
+    Value     v       = updated ? best.uciScore : best.previousScore;
+
+    result.depth = completedDepth;
+    result.score = {v == -VALUE_INFINITE ? VALUE_ZERO : v, rootPos};
+    result.nodes = nodes;
+
+    for (Move m : best.pv)
+        result.pv += UCIEngine::move(m, isChess960) + " ";
+
+    if (!result.pv.empty())
+        result.pv.pop_back();
+
+    result.bestmove = UCIEngine::move(best.pv[0], isChess960);
+
+    if (best.pv.size() > 1 || best.extract_ponder_from_tt(tt, rootPos))
+        result.ponder = UCIEngine::move(best.pv[1], isChess960);
+
+    return result;
+}
+
 // Main iterative deepening loop. It calls search()
 // repeatedly with increasing depth until the allocated thinking time has been
 // consumed, the user stops the search, or the maximum search depth is reached.
 void Search::Worker::iterative_deepening() {
 
-    SearchManager* mainThread = (is_mainthread() ? main_manager() : nullptr);
+    SearchManager* mainThread = (is_mainthread() && !batchSearch ? main_manager() : nullptr);
 
     Move pv[MAX_PLY + 1];
 
@@ -262,8 +327,8 @@ void Search::Worker::iterative_deepening() {
     int searchAgainCounter = 0;
 
     // Iterative deepening loop until requested to stop or the target depth is reached
-    while (++rootDepth < MAX_PLY && !threads.stop
-           && !(limits.depth && mainThread && rootDepth > limits.depth))
+    while (++rootDepth < MAX_PLY && !stopped()
+           && !(limits.depth && (mainThread || batchSearch) && rootDepth > limits.depth))
     {
         // Age out PV variability metric
         if (mainThread)
@@ -328,7 +393,7 @@ void Search::Worker::iterative_deepening() {
                 // If search has been stopped, we break immediately. Sorting is
                 // safe because RootMoves is still valid, although it refers to
                 // the previous iteration.
-                if (threads.stop)
+                if (stopped())
                     break;
 
                 // When failing high/low give some update before a re-search. To avoid
@@ -375,16 +440,16 @@ void Search::Worker::iterative_deepening() {
                 && !(threads.abortedSearch && rootMoves[0].uciScore <= VALUE_TB_LOSS_IN_MAX_PLY))
                 main_manager()->pv(*this, threads, tt, rootDepth);
 
-            if (threads.stop)
+            if (stopped())
                 break;
         }
 
-        if (!threads.stop)
+        if (!stopped())
             completedDepth = rootDepth;
 
         // We make sure not to pick an unproven mated-in score,
         // in case this thread prematurely stopped search (aborted-search).
-        if (threads.abortedSearch && rootMoves[0].score != -VALUE_INFINITE
+        if ((threads.abortedSearch || batchStop) && rootMoves[0].score != -VALUE_INFINITE
             && rootMoves[0].score <= VALUE_TB_LOSS_IN_MAX_PLY)
         {
             // Bring the last best move to the front for best thread selection.
@@ -556,7 +621,9 @@ Value Search::Worker::search(
     maxValue           = VALUE_INFINITE;
 
     // Check for the available remaining time
-    if (is_mainthread())
+    if (batchSearch)
+        check_batch_limits();
+    else if (is_mainthread())
         main_manager()->check_time(*thisThread);
 
     // Used to send selDepth info to GUI (selDepth counts from 1, ply from 0)
@@ -566,7 +633,7 @@ Value Search::Worker::search(
     if (!rootNode)
     {
         // Step 2. Check for aborted search and immediate draw
-        if (threads.stop.load(std::memory_order_relaxed) || pos.is_draw(ss->ply)
+        if (stopped() || pos.is_draw(ss->ply)
             || ss->ply >= MAX_PLY)
             return (ss->ply >= MAX_PLY && !ss->inCheck)
                    ? evaluate(networks[numaAccessToken], pos, refreshTable,
@@ -940,7 +1007,7 @@ moves_loop:  // When in check, search starts here
 
         ss->moveCount = ++moveCount;
 
-        if (rootNode && is_mainthread() && nodes > 10000000)
+        if (rootNode && is_mainthread() && !batchSearch && nodes > 10000000)
         {
             main_manager()->updates.onIter(
               {depth, UCIEngine::move(move, pos.is_chess960()), moveCount + thisThread->pvIdx});
@@ -1222,7 +1289,7 @@ moves_loop:  // When in check, search starts here
         // Finished searching the move. If a stop occurred, the return value of
         // the search cannot be trusted, and we return immediately without updating
         // best move, principal variation nor transposition table.
-        if (threads.stop.load(std::memory_order_relaxed))
+        if (stopped())
             return VALUE_ZERO;
 
         if (rootNode)
@@ -1851,6 +1918,22 @@ Move Skill::pick_best(const RootMoves& rootMoves, size_t multiPV) {
 }
 
 
+// Used instead of check_time() while a worker analyzes a position of its own
+// in a batch. Once a depth is completed and the position's own movetime or
+// node limit is reached, it sets batchStop, which ends only this worker's
+// search; the pool's stop flag and the other workers are left alone.
+void Search::Worker::check_batch_limits() {
+    if (--batchCallsCnt > 0)
+        return;
+
+    batchCallsCnt = limits.nodes ? std::min(512, int(limits.nodes / 1024)) : 512;
+
+    if (completedDepth >= 1
+        && ((limits.movetime && now() - limits.startTime >= limits.movetime)
+            || (limits.nodes && nodes >= limits.nodes)))
+        batchStop = true;
+}
+
 // Used to print debug info and, more importantly, to detect
 // when we are out of available time and thus stop the search.
 void SearchManager::check_time(Search::Worker& worker) {
@@ -1871,9 +1954,16 @@ void SearchManager::check_time(Search::Worker& worker) {
         dbg_print();
     }
 
-    // We should not stop pondering until told so by the GUI
+    // We should not stop pondering until told so by the GUI. The node limit
+    // still ends the search itself, so the move played after "ponderhit" was
+    // searched with no more nodes than without pondering.
     if (ponder)
+    {
+        if (worker.completedDepth >= 1 && worker.limits.nodes
+            && worker.threads.nodes_searched() >= worker.limits.nodes)
+            worker.threads.stop = worker.threads.abortedSearch = true;
         return;
+    }
 
     if (
       // Later we rely on the fact that we can at least use the mainthread previous
@@ -298,6 +298,44 @@ void ThreadPool::start_thinking(const OptionsMap&  options,
     main_thread()->start_searching();
 }
 
+// Searches many independent positions at the same time, one position per thread
+// instead of all threads on one position. Each worker takes the next position
+// as soon as it is done, so the threads stay busy until the batch is exhausted.
+// Results are passed to onResult in the order they finish, one at a time.
+// Blocks until all positions are searched or the pool is stopped.
+void ThreadPool::analyze_batch(const std::vector<std::string>&                        fens,
+                               bool                                                    isChess960,
+                               const Search::LimitsType&                               limits,
+                               const std::function<void(const Search::BatchResult&)>& onResult) {
+
+    main_thread()->wait_for_search_finished();
+
+    stop = abortedSearch = false;
+    increaseDepth        = true;
+
+    std::atomic<size_t> next{0};
+    std::mutex          resultMutex;
+
+    for (auto&& th : threads)
+    {
+        Search::Worker* worker = th->worker.get();
+
+        th->run_custom_job([&, worker]() {
+            for (size_t i = next++; i < fens.size() && !stop; i = next++)
+            {
+                Search::BatchResult result = worker->analyze_position(fens[i], isChess960, limits);
+                result.index               = i;
+
+                std::lock_guard<std::mutex> lock(resultMutex);
+                onResult(result);
+            }
+        });
+    }
+
+    for (auto&& th : threads)
+        th->wait_for_search_finished();
+}
+
 Thread* ThreadPool::get_best_thread() const {
 
     Thread* bestThread = threads.front().get();
@@ -402,6 +440,11 @@ std::vector<size_t> ThreadPool::get_bound_thread_count_by_numa_node() const {
     return counts;
 }
 
+// Returns the node the thread is bound to, 0 if threads are not bound
+NumaIndex ThreadPool::numa_node_of(size_t threadId) const {
+    return boundThreadToNumaNode.empty() ? 0 : boundThreadToNumaNode[threadId];
+}
+
 void ThreadPool::ensure_network_replicated() {
     for (auto&& th : threads)
         th->ensure_network_replicated();
@@ -21,7 +21,10 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <string>
 #include <tuple>
+#include <vector>
 
 #include "memory.h"
 #include "types.h"
@@ -69,10 +72,15 @@ struct TTWriter {
 class TranspositionTable {
 
    public:
-    ~TranspositionTable() { aligned_large_pages_free(table); }
-
-    void resize(size_t mbSize, ThreadPool& threads);  // Set TT size
-    void clear(ThreadPool& threads);                  // Re-initialize memory, multithreaded
+    ~TranspositionTable() { free_shards(shards); }
+
+    // Set TT size, keeping the entries with rehash and split by NUMA node with numaShards
+    void resize(size_t mbSize, ThreadPool& threads, bool rehash, bool numaShards);
+    void clear(ThreadPool& threads);           // Empty the table in O(1), see epoch
+    bool save(const std::string& file) const;  // Write a snapshot of the table to a file
+    bool fits(const std::string& file) const;  // Whether a snapshot in a file has the table's size
+    // Restore a snapshot of the same size, or tell in error why not
+    bool load(const std::string& file, ThreadPool& threads, std::string& error);
     int  hashfull()
       const;  // Approximate what fraction of entries (permille) have been written to during this root search
 
@@ -87,10 +95,28 @@ class TranspositionTable {
    private:
     friend struct TTEntry;
 
-    size_t   clusterCount;
-    Cluster* table = nullptr;
+    using PartFunc = std::function<void(Cluster* part, size_t index, size_t len)>;
+
+    bool allocate_shards(ThreadPool& threads);
+    void for_each_part(ThreadPool& threads, const PartFunc& f);
+    void zero(ThreadPool& threads);  // Physically zero the memory, multithreaded
+    void migrate(const std::vector<Cluster*>& oldShards,
+                 size_t                       oldShardClusterCount,
+                 ThreadPool&                  threads);
+
+    std::vector<std::vector<size_t>> threads_by_shard(const ThreadPool& threads) const;
+    Cluster*                         find_cluster(const Key key) const;
+
+    static void free_shards(std::vector<Cluster*>& shardsToFree);
+
+    size_t                clusterCount      = 0;
+    size_t                shardClusterCount = 0;
+    Cluster*              table             = nullptr;  // The whole table if there is one shard
+    std::vector<Cluster*> shards;                       // Consecutive parts of the table
+    std::vector<size_t>   shardNodes;                   // The NUMA node of each shard
 
-    uint8_t generation8 = 0;  // Size must be not bigger than TTEntry::genBound8
+    uint8_t  generation8 = 0;  // Size must be not bigger than TTEntry::genBound8
+    uint16_t epoch       = 0;  // Clusters with another epoch are treated as empty
 };
 
 }  // namespace Stockfish
@@ -21,6 +21,7 @@
 #include "bitboard.h"
 #include "misc.h"
 #include "position.h"
+#include "shmchannel.h"
 #include "types.h"
 #include "uci.h"
 #include "tune.h"
@@ -29,6 +30,9 @@ using namespace Stockfish;
 
 int main(int argc, char* argv[]) {
 
+    // A host that started us with STOCKFISH_SHM talks through shared memory
+    ShmChannel::attach_from_environment();
+
     std::cout << engine_info() << std::endl;
 
     Bitboards::init();
@@ -0,0 +1,236 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2024 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "shmchannel.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#elif !defined(__ANDROID__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #if defined(__linux__)
+        #include <ctime>
+        #include <linux/futex.h>
+        #include <sys/syscall.h>
+    #endif
+#endif
+
+namespace Stockfish::ShmChannel {
+
+namespace {
+
+Segment* segment = nullptr;
+
+#ifdef _WIN32
+HANDLE signalEvent = nullptr;  // Set by the host after writing commands
+#endif
+
+// Rounds of backoff() an engine waits for a command before it blocks on the signal
+constexpr int IdleRounds = 10000;
+
+// True if the host process has exited, so a waiting engine does not outlive it
+bool host_gone() {
+#ifdef _WIN32
+    static HANDLE host = OpenProcess(SYNCHRONIZE, FALSE, DWORD(segment->hostProcess));
+    return host && WaitForSingleObject(host, 0) == WAIT_OBJECT_0;
+#elif defined(__ANDROID__)
+    return false;
+#else
+    return std::uint64_t(getppid()) != segment->hostProcess;
+#endif
+}
+
+// Waits a little longer on every call: spin first for microsecond latency while
+// the host is busy, then yield, then sleep. The count saturates, so a long wait
+// keeps sleeping instead of overflowing back into the spinning phase.
+// Spinning is skipped on a single core, where it only delays the host.
+// Returns false if the host has gone away meanwhile.
+bool backoff(int& rounds) {
+    static const bool spin = std::thread::hardware_concurrency() > 1;
+    rounds += rounds < IdleRounds;
+    if (rounds < 200 && spin)
+        return true;
+    if (rounds < 2000)
+    {
+        std::this_thread::yield();
+        return true;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(rounds < IdleRounds ? 50 : 500));
+    return !host_gone();
+}
+
+// Blocks until the host signals new commands, for at most 100 ms so that a
+// vanished host is still noticed. Returns false if the host has gone away.
+bool wait_for_signal() {
+    segment->engineWaiting.store(1);
+    const std::uint32_t signal = segment->commandSignal.load();
+
+    // A command written before the signal was read is already in the ring
+    if (segment->commands.empty())
+    {
+#ifdef _WIN32
+        if (signalEvent)
+            WaitForSingleObject(signalEvent, 100);
+        else
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+#elif defined(__linux__) && !defined(__ANDROID__)
+        timespec timeout = {0, 100 * 1000 * 1000};
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&segment->commandSignal), FUTEX_WAIT,
+                signal, &timeout, nullptr, 0);
+#else
+        (void) signal;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+#endif
+    }
+
+    segment->engineWaiting.store(0);
+    return !host_gone();
+}
+
+// Stream buffer behind std::cout while attached: collects characters until a
+// newline and pushes the line as one record into the output ring.
+class OutputBuffer: public std::streambuf {
+   public:
+    void install() { original = std::cout.rdbuf(this); }
+
+    // std::cout outlives this static and is flushed once more at exit, so it
+    // gets its original buffer back before this one is destroyed.
+    ~OutputBuffer() override {
+        if (original)
+            std::cout.rdbuf(original);
+    }
+
+   protected:
+    int_type overflow(int_type c) override {
+        if (c != traits_type::eof())
+        {
+            char ch = traits_type::to_char_type(c);
+            xsputn(&ch, 1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        std::lock_guard<std::mutex> lock(mutex);  // Keeps the ring single-producer
+
+        for (std::streamsize i = 0; i < n; ++i)
+            if (s[i] == '\n')
+                publish();
+            else
+                line += s[i];
+
+        return n;
+    }
+
+   private:
+    void publish() {
+        int rounds = 0;
+        while (!segment->output.try_push(line))
+            if (!backoff(rounds))
+                break;  // Nobody reads the output anymore
+
+        line.clear();
+    }
+
+    std::string     line;
+    std::mutex      mutex;
+    std::streambuf* original = nullptr;
+};
+
+OutputBuffer outputBuffer;
+
+}  // namespace
+
+bool attach_from_environment() {
+
+    const char* name = std::getenv(EnvironmentVariable);
+    if (!name || !*name)
+        return false;
+
+    void* mapping = nullptr;
+
+#ifdef _WIN32
+    HANDLE file = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name);
+    if (file)
+    {
+        mapping = MapViewOfFile(file, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(Segment));
+        CloseHandle(file);  // The view keeps the mapping alive
+    }
+#elif !defined(__ANDROID__)
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd != -1)
+    {
+        mapping = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED)
+            mapping = nullptr;
+    }
+#endif
+
+    if (!mapping)
+    {
+        std::cerr << "Could not map shared memory segment " << name << std::endl;
+        return false;
+    }
+
+    Segment* s = static_cast<Segment*>(mapping);
+    if (s->magic != Magic || s->version != Version)
+    {
+        std::cerr << "Shared memory segment " << name << " has an unknown layout" << std::endl;
+#ifdef _WIN32
+        UnmapViewOfFile(mapping);
+#elif !defined(__ANDROID__)
+        munmap(mapping, sizeof(Segment));
+#endif
+        return false;
+    }
+
+    segment = s;
+#ifdef _WIN32
+    signalEvent = OpenEventA(SYNCHRONIZE, FALSE, (std::string(name) + "-signal").c_str());
+#endif
+    outputBuffer.install();
+    segment->attached.store(1, std::memory_order_release);
+    return true;
+}
+
+bool is_attached() { return segment != nullptr; }
+
+bool read_command(std::string& cmd) {
+
+    // Poll while commands follow each other closely, block once the engine is idle
+    int rounds = 0;
+    while (!segment->commands.try_pop(cmd))
+        if (rounds < IdleRounds ? !backoff(rounds) : !wait_for_signal())
+            return false;
+
+    return true;
+}
+
+}  // namespace Stockfish::ShmChannel
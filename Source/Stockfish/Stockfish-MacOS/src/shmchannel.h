@@ -0,0 +1,144 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2024 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SHMCHANNEL_H_INCLUDED
+#define SHMCHANNEL_H_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace Stockfish::ShmChannel {
+
+// Optional transport for hosts that embed Stockfish as a child process. If the
+// environment variable STOCKFISH_SHM names a shared memory segment created by the
+// host, UCI commands are read from and output lines are written to two lock-free
+// single-producer single-consumer ring buffers in that segment instead of stdin
+// and stdout. Every record carries exactly one line, so no side has to split a
+// byte stream, and no system call is made while both sides are busy. An engine
+// that has been idle for a while blocks until the host signals a new command
+// (a futex on Linux, a named event on Windows, a sleep elsewhere).
+//
+// The layout below is shared with the host and must only change together with
+// Version.
+
+constexpr const char*   EnvironmentVariable = "STOCKFISH_SHM";
+constexpr std::uint32_t Magic               = 0x31434653;  // "SFC1"
+constexpr std::uint32_t Version             = 2;
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "The rings are shared between processes and must not rely on hidden locks");
+
+// Records are a 32-bit length followed by the bytes of the line, wrapping around
+// the end of the buffer. Head and tail only grow, their difference is the fill.
+template<std::size_t Capacity>
+struct Ring {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    alignas(64) std::atomic<std::uint64_t> head;  // Written by the producer only
+    alignas(64) std::atomic<std::uint64_t> tail;  // Written by the consumer only
+    alignas(64) char data[Capacity];
+
+    // Appends a line, truncated to what fits into an empty ring. Returns false
+    // if the ring is too full at the moment.
+    bool try_push(std::string_view line) {
+        const std::uint32_t length =
+          std::uint32_t(std::min(line.size(), Capacity - sizeof(std::uint32_t)));
+        const std::uint64_t h = head.load(std::memory_order_relaxed);
+        const std::uint64_t t = tail.load(std::memory_order_acquire);
+
+        if (Capacity - (h - t) < sizeof(length) + length)
+            return false;
+
+        copy_in(h, &length, sizeof(length));
+        copy_in(h + sizeof(length), line.data(), length);
+        head.store(h + sizeof(length) + length, std::memory_order_release);
+        return true;
+    }
+
+    // True if there is no line to remove. Only the consumer may ask.
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_relaxed);
+    }
+
+    // Removes the oldest line. Returns false if the ring is empty.
+    bool try_pop(std::string& line) {
+        const std::uint64_t t = tail.load(std::memory_order_relaxed);
+        const std::uint64_t h = head.load(std::memory_order_acquire);
+
+        if (h == t)
+            return false;
+
+        std::uint32_t length;
+        copy_out(t, &length, sizeof(length));
+        line.resize(length);
+        copy_out(t + sizeof(length), line.data(), length);
+        tail.store(t + sizeof(length) + length, std::memory_order_release);
+        return true;
+    }
+
+   private:
+    void copy_in(std::uint64_t pos, const void* src, std::size_t size) {
+        const std::size_t offset = std::size_t(pos & (Capacity - 1));
+        const std::size_t first  = std::min(size, Capacity - offset);
+        std::memcpy(data + offset, src, first);
+        std::memcpy(data, static_cast<const char*>(src) + first, size - first);
+    }
+
+    void copy_out(std::uint64_t pos, void* dst, std::size_t size) const {
+        const std::size_t offset = std::size_t(pos & (Capacity - 1));
+        const std::size_t first  = std::min(size, Capacity - offset);
+        std::memcpy(dst, data + offset, first);
+        std::memcpy(static_cast<char*>(dst) + first, data, size - first);
+    }
+};
+
+// The shared memory segment. The host creates it zero-filled, sets magic, version
+// and its process id, and passes the name to the engine; the engine sets attached
+// once it reads its commands from the segment. After writing commands the host
+// increments commandSignal and, if engineWaiting is set, wakes the engine (on
+// Windows through the event named after the segment with a "-signal" suffix).
+struct Segment {
+    std::uint32_t              magic;
+    std::uint32_t              version;
+    std::uint64_t              hostProcess;
+    std::atomic<std::uint32_t> attached;
+    std::atomic<std::uint32_t> commandSignal;  // Futex word the idle engine waits on
+    std::atomic<std::uint32_t> engineWaiting;  // Set while the engine waits
+    Ring<64 * 1024>            commands;       // Host to engine, one UCI command per record
+    Ring<1024 * 1024>          output;         // Engine to host, one output line per record
+};
+
+// Maps the segment named by STOCKFISH_SHM and redirects std::cout into its output
+// ring. Returns false, leaving stdin and stdout in use, if the variable is not set
+// or the segment cannot be mapped.
+bool attach_from_environment();
+
+// True once attach_from_environment() has succeeded.
+bool is_attached();
+
+// Waits for the next command. Returns false if the host has gone away.
+bool read_command(std::string& cmd);
+
+}  // namespace Stockfish::ShmChannel
+
+#endif  // #ifndef SHMCHANNEL_H_INCLUDED
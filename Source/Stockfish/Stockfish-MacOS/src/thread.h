@@ -26,6 +26,7 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <vector>
 
 #include "numa.h"
@@ -130,6 +131,10 @@ class ThreadPool {
     ThreadPool& operator=(ThreadPool&&)      = delete;
 
     void   start_thinking(const OptionsMap&, Position&, StateListPtr&, Search::LimitsType);
+    void   analyze_batch(const std::vector<std::string>&,
+                         bool,
+                         const Search::LimitsType&,
+                         const std::function<void(const Search::BatchResult&)>&);
     void   run_on_thread(size_t threadId, std::function<void()> f);
     void   wait_on_thread(size_t threadId);
     size_t num_threads() const;
@@ -147,6 +152,7 @@ class ThreadPool {
     void                   wait_for_search_finished() const;
 
     std::vector<size_t> get_bound_thread_count_by_numa_node() const;
+    NumaIndex           numa_node_of(size_t threadId) const;
 
     void ensure_network_replicated();
 
@@ -18,17 +18,32 @@
 
 #include "tt.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 
 #include "memory.h"
 #include "misc.h"
+#include "numa.h"
 #include "syzygy/tbprobe.h"
 #include "thread.h"
 
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
 namespace Stockfish {
 
 
@@ -136,12 +151,14 @@ void TTWriter::write(
 // A TranspositionTable is an array of Cluster, of size clusterCount. Each cluster consists of ClusterSize number
 // of TTEntry. Each non-empty TTEntry contains information on exactly one position. The size of a Cluster should
 // divide the size of a cache line for best performance, as the cacheline is prefetched when possible.
+// The padding holds the table epoch of the cluster's entries: clusters of an older epoch are empty, so clear() only
+// has to advance the epoch, and each cluster is zeroed when probe() first reaches it afterwards.
 
 static constexpr int ClusterSize = 3;
 
 struct Cluster {
-    TTEntry entry[ClusterSize];
-    char    padding[2];  // Pad to 32 bytes
+    TTEntry  entry[ClusterSize];
+    uint16_t epoch;  // Pads to 32 bytes
 };
 
 static_assert(sizeof(Cluster) == 32, "Suboptimal Cluster size");
@@ -150,43 +167,422 @@ static_assert(sizeof(Cluster) == 32, "Suboptimal Cluster size");
 // Sets the size of the transposition table,
 // measured in megabytes. Transposition table consists
 // of clusters and each cluster consists of ClusterSize number of TTEntry.
-void TranspositionTable::resize(size_t mbSize, ThreadPool& threads) {
-    aligned_large_pages_free(table);
+// With rehash the entries are moved to the new table, which needs memory
+// for both tables for a moment; without it the table starts empty.
+// With numaShards the table is split into one shard per NUMA node that has
+// bound threads, see find_cluster().
+void TranspositionTable::resize(size_t mbSize, ThreadPool& threads, bool rehash, bool numaShards) {
+
+    std::vector<Cluster*> oldShards            = std::move(shards);
+    size_t                oldShardClusterCount = shardClusterCount;
+
+    table = nullptr;
+
+    if (!rehash)
+        free_shards(oldShards);
 
-    clusterCount = mbSize * 1024 * 1024 / sizeof(Cluster);
+    shardNodes.clear();
+    if (numaShards)
+    {
+        const std::vector<size_t> counts = threads.get_bound_thread_count_by_numa_node();
+        for (NumaIndex n = 0; n < counts.size(); ++n)
+            if (counts[n])
+                shardNodes.push_back(n);
+    }
+    if (shardNodes.empty())
+        shardNodes.push_back(0);
 
-    table = static_cast<Cluster*>(aligned_large_pages_alloc(clusterCount * sizeof(Cluster)));
+    shardClusterCount = mbSize * 1024 * 1024 / sizeof(Cluster) / shardNodes.size();
+    clusterCount      = shardClusterCount * shardNodes.size();
 
-    if (!table)
+    // Not enough memory for both tables, give up the old entries
+    if (!allocate_shards(threads) && !oldShards.empty())
+    {
+        free_shards(oldShards);
+        allocate_shards(threads);
+    }
+
+    if (shards.empty())
     {
         std::cerr << "Failed to allocate " << mbSize << "MB for transposition table." << std::endl;
         exit(EXIT_FAILURE);
     }
 
-    clear(threads);
+    if (!oldShards.empty())
+    {
+        migrate(oldShards, oldShardClusterCount, threads);
+        free_shards(oldShards);
+        return;
+    }
+
+    generation8 = 0;
+    epoch       = 0;
+    zero(threads);
+}
+
+
+// Allocates every shard on a thread bound to its node, so that memory
+// committed right away (large pages on Windows) is local too. Other pages
+// are placed when the threads of the node first touch them in zero().
+bool TranspositionTable::allocate_shards(ThreadPool& threads) {
+
+    const std::vector<std::vector<size_t>> shardThreads = threads_by_shard(threads);
+
+    shards.assign(shardNodes.size(), nullptr);
+    for (size_t s = 0; s < shards.size(); ++s)
+        threads.run_on_thread(shardThreads[s].front(), [this, s]() {
+            shards[s] =
+              static_cast<Cluster*>(aligned_large_pages_alloc(shardClusterCount * sizeof(Cluster)));
+        });
+
+    for (size_t s = 0; s < shards.size(); ++s)
+        threads.wait_on_thread(shardThreads[s].front());
+
+    if (std::find(shards.begin(), shards.end(), nullptr) == shards.end())
+    {
+        table = shards.size() == 1 ? shards[0] : nullptr;
+        return true;
+    }
+
+    free_shards(shards);
+    return false;
+}
+
+
+void TranspositionTable::free_shards(std::vector<Cluster*>& shardsToFree) {
+    for (Cluster* shard : shardsToFree)
+        aligned_large_pages_free(shard);
+
+    shardsToFree.clear();
+}
+
+
+// Returns the threads working on each shard: those bound to the node of the
+// shard. Without shards, or with threads that are not bound, all of them.
+std::vector<std::vector<size_t>>
+TranspositionTable::threads_by_shard(const ThreadPool& threads) const {
+
+    std::vector<std::vector<size_t>> shardThreads(shardNodes.size());
+
+    for (size_t i = 0; i < threads.num_threads(); ++i)
+    {
+        const NumaIndex n     = threads.numa_node_of(i);
+        const auto      node  = std::find(shardNodes.begin(), shardNodes.end(), n);
+        const size_t    shard = node != shardNodes.end() ? size_t(node - shardNodes.begin()) : 0;
+        shardThreads[shard].push_back(i);
+    }
+
+    return shardThreads;
+}
+
+
+// Splits every shard between the threads working on it and calls f on each
+// part with its first cluster, the index of that cluster in the whole table
+// (as if it were contiguous) and the number of clusters. Waits for all parts.
+void TranspositionTable::for_each_part(ThreadPool& threads, const PartFunc& f) {
+
+    const std::vector<std::vector<size_t>> shardThreads = threads_by_shard(threads);
+
+    for (size_t s = 0; s < shards.size(); ++s)
+        for (size_t r = 0; r < shardThreads[s].size(); ++r)
+        {
+            const size_t partCount = shardThreads[s].size();
+
+            threads.run_on_thread(shardThreads[s][r], [this, &f, s, r, partCount]() {
+                const size_t stride = shardClusterCount / partCount;
+                const size_t start  = stride * r;
+                const size_t len    = r + 1 != partCount ? stride : shardClusterCount - start;
+
+                f(&shards[s][start], s * shardClusterCount + start, len);
+            });
+        }
+
+    for (size_t i = 0; i < threads.num_threads(); ++i)
+        threads.wait_on_thread(i);
+}
+
+
+// Empties the table in constant time by starting a new epoch. The
+// memory is zeroed only once the 16-bit epoch wraps around.
+void TranspositionTable::clear(ThreadPool& threads) {
+    generation8 = 0;
+
+    if (++epoch == 0)
+        zero(threads);
 }
 
 
 // Initializes the entire transposition table to zero,
 // in a multi-threaded way.
-void TranspositionTable::clear(ThreadPool& threads) {
-    generation8              = 0;
-    const size_t threadCount = threads.num_threads();
+void TranspositionTable::zero(ThreadPool& threads) {
+    // Each thread will zero its part of the hash table
+    for_each_part(threads, [](Cluster* part, size_t, size_t len) {
+        std::memset(static_cast<void*>(part), 0, len * sizeof(Cluster));
+    });
+}
+
+
+// Returns whether a * b < c * d, using the full 128-bit products
+static bool product_less(uint64_t a, uint64_t b, uint64_t c, uint64_t d) {
+    const uint64_t hi1 = mul_hi64(a, b), hi2 = mul_hi64(c, d);
+    return hi1 < hi2 || (hi1 == hi2 && a * b < c * d);
+}
+
+
+// Fills the table from an old table of another size, in a multi-threaded way.
+// An entry keeps only 16 bits of its key, so the new cluster of a position is
+// not known exactly: each new cluster takes the most valuable entries of all
+// old clusters that can hold its keys. When the table grows, an old cluster is
+// thus copied to all the new clusters it covers; the copies that landed in the
+// wrong cluster collide no more often than any other entry and age out.
+void TranspositionTable::migrate(const std::vector<Cluster*>& oldShards,
+                                 size_t                       oldShardClusterCount,
+                                 ThreadPool&                  threads) {
+
+    const size_t   oldClusterCount = oldShards.size() * oldShardClusterCount;
+    const uint64_t keyStep         = ~uint64_t(0) / clusterCount;  // Keys per cluster, rounded down
+    const auto     worth           = [this](const TTEntry& tte) {
+        return tte.depth8 - tte.relative_age(generation8) * 2;
+    };
+
+    // Each thread will fill its part of the hash table
+    for_each_part(threads, [&](Cluster* part, size_t index, size_t len) {
+        for (size_t j = index; j < index + len; ++j)
+        {
+            // The old clusters k whose keys [k / oldCount, (k + 1) / oldCount) of the key space
+            // overlap those of cluster j. Start from the old cluster of a key at most j / count.
+            size_t first = size_t(mul_hi64(j * keyStep, oldClusterCount));
+            while (!product_less(j, oldClusterCount, first + 1, clusterCount))
+                ++first;
+
+            size_t last = first;
+            while (last + 1 < oldClusterCount
+                   && product_less(last + 1, clusterCount, j + 1, oldClusterCount))
+                ++last;
+
+            Cluster cluster;
+            std::memset(static_cast<void*>(&cluster), 0, sizeof(Cluster));
+            cluster.epoch = epoch;
+            int filled    = 0;
+
+            for (size_t k = first; k <= last; ++k)
+            {
+                const Cluster& old = oldShards[k / oldShardClusterCount][k % oldShardClusterCount];
+
+                if (old.epoch != epoch)
+                    continue;
+
+                for (const TTEntry& candidate : old.entry)
+                {
+                    if (!candidate.is_occupied())
+                        continue;
+
+                    if (filled < ClusterSize)
+                    {
+                        cluster.entry[filled++] = candidate;
+                        continue;
+                    }
+
+                    // Replace the least valuable entry, by the same measure as probe()
+                    TTEntry* replace = &cluster.entry[0];
+                    for (int l = 1; l < ClusterSize; ++l)
+                        if (worth(*replace) > worth(cluster.entry[l]))
+                            replace = &cluster.entry[l];
+
+                    if (worth(*replace) < worth(candidate))
+                        *replace = candidate;
+                }
+            }
+
+            part[j - index] = cluster;
+        }
+    });
+}
 
-    for (size_t i = 0; i < threadCount; ++i)
+
+// A snapshot file is a header followed by the clusters in their native layout,
+// so it can only be restored into a table of the same size by the same build.
+struct TTFileHeader {
+    uint64_t magic;
+    uint64_t clusterCount;
+    uint32_t clusterSize;
+    uint16_t epoch;
+    uint8_t  generation8;
+    uint8_t  padding[9];  // Keeps the clusters 32-byte aligned in the mapping
+};
+
+static_assert(sizeof(TTFileHeader) == sizeof(Cluster), "Misaligned snapshot header");
+
+static constexpr uint64_t TTFileMagic = 0x3148534148544653;  // "SFTHASH1" on little endian machines
+
+namespace {
+
+// Returns why a snapshot with this header and file size cannot be restored into
+// a table of clusterCount clusters, or an empty string if it can.
+std::string snapshot_mismatch(const TTFileHeader& header, size_t fileSize, size_t clusterCount) {
+
+    auto mb = [](uint64_t clusters) {
+        return std::to_string(clusters * sizeof(Cluster) / (1024 * 1024)) + " MB";
+    };
+
+    if (header.magic != TTFileMagic)
+        return "not a hash snapshot (bad magic)";
+
+    if (header.clusterSize != sizeof(Cluster))
+        return "cluster size " + std::to_string(header.clusterSize) + " of another build, expected "
+             + std::to_string(sizeof(Cluster));
+
+    if ((header.generation8 & ~GENERATION_MASK) != 0)
+        return "corrupt header (invalid generation)";
+
+    if (header.clusterCount != clusterCount)
+        return "snapshot of " + mb(header.clusterCount) + ", but Hash is " + mb(clusterCount);
+
+    if (fileSize != sizeof(header) + clusterCount * sizeof(Cluster))
+        return "file size " + std::to_string(fileSize) + " bytes, expected "
+             + std::to_string(sizeof(header) + clusterCount * sizeof(Cluster))
+             + (fileSize < sizeof(header) + clusterCount * sizeof(Cluster) ? " (short file)" : "");
+
+    return std::string();
+}
+
+// Read-only view of a whole file, unmapped on destruction
+class MappedFile {
+   public:
+    explicit MappedFile(const std::string& file) {
+#ifdef _WIN32
+        HANDLE fh = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (fh == INVALID_HANDLE_VALUE)
+            return;
+
+        LARGE_INTEGER fileSize;
+        HANDLE        mapping = nullptr;
+        if (GetFileSizeEx(fh, &fileSize) && fileSize.QuadPart > 0)
+            mapping = CreateFileMappingA(fh, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(fh);
+
+        if (mapping)
+        {
+            data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            size = data ? size_t(fileSize.QuadPart) : 0;
+            CloseHandle(mapping);  // The view keeps the mapping alive
+        }
+#else
+        int fd = open(file.c_str(), O_RDONLY);
+        if (fd == -1)
+            return;
+
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void* mapping = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED)
+            {
+                data = mapping;
+                size = size_t(st.st_size);
+            }
+        }
+        close(fd);  // The mapping keeps the file open
+#endif
+    }
+
+    ~MappedFile() {
+        if (!data)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+#else
+        munmap(data, size);
+#endif
+    }
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* bytes() const { return static_cast<const char*>(data); }
+
+    void*  data = nullptr;
+    size_t size = 0;
+};
+
+}  // namespace
+
+
+// Writes the header and the raw clusters, including the
+// generation, so that a restored table ages its entries correctly.
+bool TranspositionTable::save(const std::string& file) const {
+
+    TTFileHeader header{};
+    header.magic        = TTFileMagic;
+    header.clusterCount = clusterCount;
+    header.clusterSize  = uint32_t(sizeof(Cluster));
+    header.epoch        = epoch;
+    header.generation8  = generation8;
+
+    std::ofstream stream(file, std::ios::binary);
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const Cluster* shard : shards)
+        stream.write(reinterpret_cast<const char*>(shard),
+                     std::streamsize(shardClusterCount * sizeof(Cluster)));
+    stream.close();
+
+    return !stream.fail();
+}
+
+
+// Maps a snapshot and copies it into the table, in a multi-threaded
+// way like zero(), so each thread touches the same part of the memory.
+// The table is left untouched if the file does not match its size, and
+// 'error' tells what is wrong with the file.
+// Snapshots do not depend on the shards, see find_cluster().
+bool TranspositionTable::load(const std::string& file, ThreadPool& threads, std::string& error) {
+
+    const MappedFile mapped(file);
+    if (!mapped.data)
     {
-        threads.run_on_thread(i, [this, i, threadCount]() {
-            // Each thread will zero its part of the hash table
-            const size_t stride = clusterCount / threadCount;
-            const size_t start  = stride * i;
-            const size_t len    = i + 1 != threadCount ? stride : clusterCount - start;
+        error = "cannot open or map the file, or it is empty";
+        return false;
+    }
 
-            std::memset(&table[start], 0, len * sizeof(Cluster));
-        });
+    if (mapped.size < sizeof(TTFileHeader))
+    {
+        error = "file too short for a snapshot header";
+        return false;
     }
 
-    for (size_t i = 0; i < threadCount; ++i)
-        threads.wait_on_thread(i);
+    TTFileHeader header;
+    std::memcpy(&header, mapped.bytes(), sizeof(header));
+
+    error = snapshot_mismatch(header, mapped.size, clusterCount);
+    if (!error.empty())
+        return false;
+
+    const char* source = mapped.bytes() + sizeof(header);
+
+    for_each_part(threads, [source](Cluster* part, size_t index, size_t len) {
+        std::memcpy(static_cast<void*>(part), source + index * sizeof(Cluster),
+                    len * sizeof(Cluster));
+    });
+
+    epoch       = header.epoch;
+    generation8 = header.generation8;
+    return true;
+}
+
+
+// Reads only the header, so that a snapshot of another size is not mapped
+bool TranspositionTable::fits(const std::string& file) const {
+
+    std::ifstream stream(file, std::ios::binary | std::ios::ate);
+    const auto    fileSize = stream.tellg();
+
+    TTFileHeader header;
+    stream.seekg(0);
+    if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return false;
+
+    return snapshot_mismatch(header, size_t(fileSize), clusterCount).empty();
 }
 
 
@@ -196,10 +592,14 @@ void TranspositionTable::clear(ThreadPool& threads) {
 int TranspositionTable::hashfull() const {
 
     int cnt = 0;
-    for (int i = 0; i < 1000; ++i)
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        const Cluster& cluster = shards[i / shardClusterCount][i % shardClusterCount];
+
         for (int j = 0; j < ClusterSize; ++j)
-            cnt += table[i].entry[j].is_occupied()
-                && (table[i].entry[j].genBound8 & GENERATION_MASK) == generation8;
+            cnt += cluster.epoch == epoch && cluster.entry[j].is_occupied()
+                && (cluster.entry[j].genBound8 & GENERATION_MASK) == generation8;
+    }
 
     return cnt / ClusterSize;
 }
@@ -222,8 +622,17 @@ uint8_t TranspositionTable::generation() const { return generation8; }
 // TTEntry t2 if its replace value is greater than that of t2.
 std::tuple<bool, TTData, TTWriter> TranspositionTable::probe(const Key key) const {
 
-    TTEntry* const tte   = first_entry(key);
-    const uint16_t key16 = uint16_t(key);  // Use the low 16 bits as key inside the cluster
+    Cluster* const cluster = find_cluster(key);
+    TTEntry* const tte     = &cluster->entry[0];
+    const uint16_t key16   = uint16_t(key);  // Use the low 16 bits as key inside the cluster
+
+    // The cluster was last written before clear(), so empty it now. This races like any other write.
+    if (cluster->epoch != epoch)
+    {
+        std::memset(static_cast<void*>(cluster), 0, sizeof(Cluster));
+        cluster->epoch = epoch;
+        return {false, TTData(), TTWriter(tte)};
+    }
 
     for (int i = 0; i < ClusterSize; ++i)
         if (tte[i].key16 == key16)
@@ -243,7 +652,22 @@ std::tuple<bool, TTData, TTWriter> TranspositionTable::probe(const Key key) cons
 
 
 TTEntry* TranspositionTable::first_entry(const Key key) const {
-    return &table[mul_hi64(key, clusterCount)].entry[0];
+    return &find_cluster(key)->entry[0];
+}
+
+
+// The shards hold equal parts of the clusters of a contiguous table, and a key
+// gets the same cluster as mul_hi64(key, clusterCount) there: the high part of
+// the product picks the shard and its low part the cluster within the shard.
+// With a single shard, the plain contiguous table is indexed directly, so
+// the default configuration pays nothing for the shards.
+Cluster* TranspositionTable::find_cluster(const Key key) const {
+    if (table)
+        return &table[mul_hi64(key, clusterCount)];
+
+    const size_t shardCount = shards.size();
+
+    return &shards[mul_hi64(key, shardCount)][mul_hi64(key * shardCount, shardClusterCount)];
 }
 
 }  // namespace Stockfish
@@ -66,18 +66,28 @@ Engine::Engine(std::string path) :
     });
 
     options["NumaPolicy"] << Option("auto", [this](const Option& o) {
-        set_numa_config_from_option(o);
-        return numa_config_information_as_string() + "\n" + thread_binding_information_as_string();
+        const auto loaded = set_numa_config_from_option(o);
+        return numa_config_information_as_string() + "\n" + thread_binding_information_as_string()
+             + (loaded ? "\n" + *loaded : "");
     });
 
     options["Threads"] << Option(1, 1, 1024, [this](const Option&) {
-        resize_threads();
-        return thread_binding_information_as_string();
+        const auto loaded = resize_threads();
+        return thread_binding_information_as_string() + (loaded ? "\n" + *loaded : "");
     });
 
     options["Hash"] << Option(16, 1, MaxHashMB, [this](const Option& o) {
         set_tt_size(o);
-        return std::nullopt;
+        return load_hash_file(true);
+    });
+
+    options["HashFile"] << Option("", [this](const Option&) { return load_hash_file(); });
+
+    options["RehashOnResize"] << Option(false);
+
+    options["NumaHash"] << Option(false, [this](const Option&) {
+        set_tt_size(options["Hash"]);
+        return load_hash_file(true);
     });
 
     options["Clear Hash"] << Option([this](const Option&) {
@@ -128,7 +138,23 @@ void Engine::go(Search::LimitsType& limits) {
 
     threads.start_thinking(options, pos, states, limits);
 }
-void Engine::stop() { threads.stop = true; }
+void Engine::stop() {
+    threads.stop                   = true;
+    threads.main_manager()->ponder = false;  // Also ends a ponder search waiting for "ponderhit"
+}
+
+void Engine::analyze_batch(const std::vector<std::string>&           fens,
+                           const Search::LimitsType&                 limits,
+                           std::function<void(const BatchResult&)>&& onResult) {
+    assert(limits.perft == 0);
+    verify_networks();
+
+    // Every position is a new search; the hash table is shared by all of them
+    wait_for_search_finished();
+    tt.new_search();
+
+    threads.analyze_batch(fens, options["UCI_Chess960"], limits, onResult);
+}
 
 void Engine::search_clear() {
     wait_for_search_finished();
@@ -183,7 +209,7 @@ void Engine::set_position(const std::string& fen, const std::vector<std::string>
 
 // modifiers
 
-void Engine::set_numa_config_from_option(const std::string& o) {
+std::optional<std::string> Engine::set_numa_config_from_option(const std::string& o) {
     if (o == "auto" || o == "system")
     {
         numaContext.set_numa_config(NumaConfig::from_system());
@@ -203,22 +229,51 @@ void Engine::set_numa_config_from_option(const std::string& o) {
     }
 
     // Force reallocation of threads in case affinities need to change.
-    resize_threads();
+    const auto loaded = resize_threads();
     threads.ensure_network_replicated();
+    return loaded;
 }
 
-void Engine::resize_threads() {
+std::optional<std::string> Engine::resize_threads() {
     threads.wait_for_search_finished();
     threads.set(numaContext.get_numa_config(), {options, threads, tt, networks}, updateContext);
 
     // Reallocate the hash with the new threadpool size
     set_tt_size(options["Hash"]);
     threads.ensure_network_replicated();
+    return load_hash_file(true);
 }
 
 void Engine::set_tt_size(size_t mb) {
     wait_for_search_finished();
-    tt.resize(mb, threads);
+    tt.resize(mb, threads, options["RehashOnResize"], options["NumaHash"]);
+}
+
+std::string Engine::save_tt(const std::string& file) {
+    wait_for_search_finished();
+
+    return tt.save(file) ? "Hash saved to " + file : "Failed to save hash to " + file;
+}
+
+std::string Engine::load_tt(const std::string& file) {
+    wait_for_search_finished();
+
+    std::string error;
+    return tt.load(file, threads, error) ? "Hash loaded from " + file
+                                         : "Failed to load hash from " + file + ": " + error;
+}
+
+// The snapshot named by the HashFile option is restored whenever it is set,
+// and after every reallocation of the table (Hash, NumaHash, Threads and
+// NumaPolicy) if it has the table's new size, so the options can be given in
+// either order.
+std::optional<std::string> Engine::load_hash_file(bool afterResize) {
+    const std::string file = options["HashFile"];
+
+    if (file.empty() || (afterResize && !tt.fits(file)))
+        return std::nullopt;
+
+    return load_tt(file);
 }
 
 void Engine::set_ponderhit(bool b) { threads.main_manager()->ponder = b; }
@@ -180,6 +180,17 @@ struct InfoIteration {
     size_t           currmovenumber;
 };
 
+// Result of one position searched by ThreadPool::analyze_batch
+struct BatchResult {
+    size_t      index;     // Index of the position in the batch
+    std::string bestmove;  // "(none)" if the position has no legal moves
+    std::string ponder;    // Empty if there is no expected reply
+    std::string pv;
+    int         depth;     // Last completed iteration
+    Score       score;
+    uint64_t    nodes;
+};
+
 // Skill structure is used to implement strength limit. If we have a UCI_Elo,
 // we convert it to an appropriate skill level, anchored to the Stash engine.
 // This method is based on a fit of the Elo results for games played between
@@ -274,6 +285,10 @@ class Worker {
 
     bool is_mainthread() const { return threadIdx == 0; }
 
+    // Searches a position on its own, without the other threads and without the
+    // main thread's time management. Used by ThreadPool::analyze_batch.
+    BatchResult analyze_position(const std::string& fen, bool isChess960, const LimitsType&);
+
     void ensure_network_replicated();
 
     // Public because they need to be updatable by the stats
@@ -305,6 +320,10 @@ class Worker {
     TimePoint elapsed() const;
     TimePoint elapsed_time() const;
 
+    // While analyzing a position of its own the worker enforces its limits itself
+    void check_batch_limits();
+    bool stopped() const;
+
     LimitsType limits;
 
     size_t                pvIdx, pvLast;
@@ -330,6 +349,9 @@ class Worker {
 
     Tablebases::Config tbConfig;
 
+    bool batchSearch = false, batchStop = false;
+    int  batchCallsCnt = 0;
+
     const OptionsMap&                               options;
     ThreadPool&                                     threads;
     TranspositionTable&                             tt;
@@ -34,6 +34,7 @@
 #include "position.h"
 #include "score.h"
 #include "search.h"
+#include "shmchannel.h"
 #include "types.h"
 #include "ucioption.h"
 
@@ -85,7 +86,9 @@ void UCIEngine::loop() {
     do
     {
         if (cli.argc == 1
-            && !getline(std::cin, cmd))  // Wait for an input or an end-of-file (EOF) indication
+            && !(ShmChannel::is_attached()
+                   ? ShmChannel::read_command(cmd)  // Wait for a command or the host to exit
+                   : bool(getline(std::cin, cmd))))  // Wait for an input or an end-of-file (EOF) indication
             cmd = "quit";
 
         std::istringstream is(cmd);
@@ -151,6 +154,18 @@ void UCIEngine::loop() {
 
             engine.save_network(files);
         }
+        else if (token == "tt")
+        {
+            std::string action, file;
+            is >> std::skipws >> action >> file;
+
+            if (action == "save" && !file.empty())
+                print_info_string(engine.save_tt(file));
+            else if (action == "load" && !file.empty())
+                print_info_string(engine.load_tt(file));
+            else
+                sync_cout << "Usage: tt save <file> | tt load <file>" << sync_endl;
+        }
         else if (token == "--help" || token == "help" || token == "--license" || token == "license")
             sync_cout
               << "\nStockfish is a powerful chess engine for playing and analyzing."